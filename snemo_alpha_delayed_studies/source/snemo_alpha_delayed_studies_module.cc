@@ -7,10 +7,14 @@
 #include <stdexcept>
 #include <sstream>
 #include <algorithm>
+#include <map>
+#include <limits>
+#include <cmath>
 
 // Third party:
 // - Bayeux/datatools:
 #include <datatools/service_manager.h>
+#include <datatools/utils.h>
 // - Bayeux/mygsl
 #include <mygsl/histogram_pool.h>
 // - Bayeux/dpp
@@ -25,6 +29,9 @@
 #include <snemo/datamodels/topology_data.h>
 #include <snemo/datamodels/topology_1e1a_pattern.h>
 
+// - Shared event view
+#include <event_view_service.h>
+
 namespace snemo {
 namespace analysis {
 
@@ -55,6 +62,18 @@ namespace analysis {
   void snemo_alpha_delayed_studies_module::_set_defaults()
   {
     _histogram_pool_ = 0;
+    _use_geiger_count_ = false;
+    _geiger_delta_histogram_ = 0;
+    _view_ = 0;
+    _shared_view_ = 0;
+    _shared_view_serial_ = 0;
+    _shared_view_checked_ = false;
+    _delayed_mode_ = false;
+    _time_cluster_gap_ = 1 * CLHEP::microsecond;
+    _delayed_time_histogram_ = 0;
+    _vertex_distance_histogram_ = 0;
+    _time_clusters_histogram_ = 0;
+    _time_spread_histogram_ = 0;
     return;
   }
 
@@ -105,6 +124,48 @@ namespace analysis {
     if (config_.has_key("select_geiger_range")) {
       config_.fetch("select_geiger_range", _selected_geiger_range_);
     }
+    _build_geiger_routes_();
+
+    if (config_.has_key("geiger_vs_delta_track_length")) {
+      if (config_.fetch_boolean("geiger_vs_delta_track_length")) {
+        _geiger_delta_histogram_ = &_grab_histogram_2d_("1e1a::geiger_vs_delta_track_length",
+                                                        "1e1a::geiger_vs_delta_template");
+      }
+    }
+    _use_geiger_count_ = ! _selected_geiger_range_.empty() || _geiger_delta_histogram_ != 0;
+
+    // Delayed alpha timing and vertex association
+    if (config_.has_key("delayed_mode")) {
+      _delayed_mode_ = config_.fetch_boolean("delayed_mode");
+    }
+    if (_delayed_mode_) {
+      if (config_.has_key("delayed.time_cluster_gap")) {
+        _time_cluster_gap_ = config_.fetch_real("delayed.time_cluster_gap");
+        if (! config_.has_explicit_unit("delayed.time_cluster_gap")) _time_cluster_gap_ *= CLHEP::ns;
+      }
+      DT_THROW_IF(_time_cluster_gap_ <= 0.0, std::logic_error,
+                  "Time gap between geiger clusters must be positive !");
+      _delayed_time_histogram_    = &_grab_histogram_1d_("1e1a::delta_delayed_time",
+                                                         "1e1a::delta_time_template");
+      _vertex_distance_histogram_ = &_grab_histogram_1d_("1e1a::alpha_electron_vertex_distance",
+                                                         "1e1a::vertex_distance_template");
+      _time_clusters_histogram_   = &_grab_histogram_1d_("1e1a::geiger_time_clusters",
+                                                         "1e1a::multiplicity_template");
+      _time_spread_histogram_     = &_grab_histogram_1d_("1e1a::alpha_geiger_time_spread",
+                                                         "1e1a::time_spread_template");
+    }
+
+    // Banks and step hits may be shared with other modules through the event view
+    if (config_.has_key("EventView_label")) {
+      const std::string view_label = config_.fetch_string("EventView_label");
+      DT_THROW_IF(! service_manager_.has(view_label) ||
+                  ! service_manager_.is_a<event_view_service>(view_label),
+                  std::logic_error,
+                  "Module '" << get_name() << "' has no '" << view_label << "' service !");
+      _shared_view_ = &service_manager_.grab<event_view_service>(view_label).grab_view();
+      _shared_view_serial_ = _shared_view_->get_serial();
+    }
+    _view_ = &_local_view_;
 
     // Tag the module as initialized :
     _set_initialized(true);
@@ -119,6 +180,13 @@ namespace analysis {
 
     // Tag the module as un-initialized :
     _set_initialized(false);
+    _local_view_.clear();
+    _selected_geiger_range_.clear();
+    _delta_histograms_.clear();
+    _geiger_routes_.clear();
+    _simulated_alphas_.clear();
+    _reconstructed_alphas_.clear();
+    _geiger_times_.clear();
     _set_defaults();
     return;
   }
@@ -145,105 +213,154 @@ namespace analysis {
     DT_THROW_IF(! is_initialized(), std::logic_error,
                 "Module '" << get_name() << "' is not initialized !");
 
-    alpha_list_type simulated_alphas;
-    this->_process_simulated_alphas(data_record_, simulated_alphas);
+    // The shared view is only used if the 'event_view_module' has bound it to
+    // a new record since the previous call: the record object being reused by
+    // dpp, its address can not tell a stale view
+    _view_ = &_local_view_;
+    if (_shared_view_ != 0) {
+      const uint64_t a_serial = _shared_view_->get_serial();
+      if (a_serial != _shared_view_serial_) {
+        _shared_view_serial_ = a_serial;
+        _view_ = _shared_view_;
+      } else if (! _shared_view_checked_) {
+        DT_LOG_WARNING(get_logging_priority(), "The 'event_view_module' is missing or not run before module '"
+                       << get_name() << "': the shared event view is not used !");
+        _shared_view_ = 0;
+      } else {
+        DT_LOG_WARNING(get_logging_priority(), "Shared event view is not bound to the current record !");
+      }
+      _shared_view_checked_ = true;
+    }
+    if (_view_ == &_local_view_) _local_view_.reset(data_record_);
 
-    alpha_list_type reconstructed_alphas;
-    this->_process_reconstructed_alphas(data_record_, reconstructed_alphas);
+    // Alpha lists are reused from one event to the other
+    _simulated_alphas_.clear();
+    this->_process_simulated_alphas(_simulated_alphas_);
 
-    this->_compare_track_length(simulated_alphas, reconstructed_alphas);
+    _reconstructed_alphas_.clear();
+    this->_process_reconstructed_alphas(_reconstructed_alphas_);
+
+    this->_compare_track_length(_simulated_alphas_, _reconstructed_alphas_);
+    if (_delayed_mode_) {
+      this->_compare_delayed_alpha(_simulated_alphas_, _reconstructed_alphas_);
+    }
 
     DT_LOG_TRACE(get_logging_priority(), "Exiting.");
     return dpp::base_module::PROCESS_SUCCESS;
   }
 
-  void snemo_alpha_delayed_studies_module::_process_simulated_alphas(const datatools::things & data_record_,
-                                                                     alpha_list_type & simulated_alphas_)
+  void snemo_alpha_delayed_studies_module::_process_simulated_alphas(alpha_list_type & simulated_alphas_)
   {
-    // Check if some 'simulated_data' are available in the data model:
-    const std::string sd_label = snemo::datamodel::data_info::default_simulated_data_label();
-    if (! data_record_.has(sd_label)) {
+    // Get the 'simulated_data' entry from the event view :
+    const mctools::simulated_data * sd = _view_->get_simulated_data();
+    if (sd == 0) {
       DT_LOG_ERROR(get_logging_priority(), "Missing simulated data to be processed !");
       return;
     }
-    // Get the 'simulated_data' entry from the data model :
-    const mctools::simulated_data & sd = data_record_.get<mctools::simulated_data>(sd_label);
 
     DT_LOG_DEBUG(get_logging_priority(), "Simulated data : ");
-    if (get_logging_priority() >= datatools::logger::PRIO_DEBUG) sd.tree_dump();
-
-    // Fetch simulated step hits
-    const std::string hit_label = "__visu.tracks";
-    if (! sd.has_step_hits(hit_label)) return;
-    const mctools::simulated_data::hit_handle_collection_type & hit_collection
-      = sd.get_step_hits(hit_label);
-    if (hit_collection.empty()) {
+    if (get_logging_priority() >= datatools::logger::PRIO_DEBUG) sd->tree_dump();
+
+    // Fetch simulated step hits grouped by track
+    static const std::string hit_label = "__visu.tracks";
+    const step_hit_index & a_step_hits = _view_->grab_step_hits(hit_label);
+    if (a_step_hits.get_number_of_tracks() == 0) {
       DT_LOG_DEBUG(get_logging_priority(), "No simulated step hits");
       return;
     }
+    if (a_step_hits.get_number_of_orphan_steps() > 0) {
+      DT_LOG_WARNING(get_logging_priority(), "Missing track id for "
+                     << a_step_hits.get_number_of_orphan_steps() << " step hits !");
+    }
 
-    std::set<int> track_id_list;
-    for (auto ihit : hit_collection) {
-      const mctools::base_step_hit & a_hit = ihit.get();
-
-      // Check if step comes from alpha particle
-      const std::string a_label = a_hit.get_particle_name();
-      if (a_label != "alpha") continue;
-
-      // Check also if the alpha is a primary particle
-      if (! a_hit.is_primary_particle()) continue;
-
-      // Finally check track id
-      if (! a_hit.has_track_id()) {
-        DT_LOG_WARNING(get_logging_priority(), "Missing track id !");
-        continue;
-      }
-      if (! track_id_list.count(a_hit.get_track_id())) {
-        track_id_list.insert(a_hit.get_track_id());
-        alpha_track_parameters dummy;
-        simulated_alphas_.push_back(dummy);
+    const int alpha_id = a_step_hits.find_particle_id("alpha");
+    if (alpha_id < 0) return;
+    for (size_t i = 0; i < a_step_hits.get_number_of_tracks(); i++) {
+      const step_hit_index::track_type & a_track = a_step_hits.get_track(i);
+
+      // Check if track comes from a primary alpha particle
+      if (a_track.particle_id != alpha_id) continue;
+      if (! a_track.primary) continue;
+
+      alpha_track_parameters alpha = {0, 0, datatools::invalid_real(), datatools::invalid_real(),
+                                      0, datatools::invalid_real()};
+      alpha.length = a_track.length;
+      // The first step of the track gives the alpha emission time
+      if (a_track.end > a_track.begin) {
+        alpha.delayed_time = a_step_hits.get_step(a_track.begin).get_time_start();
       }
-      alpha_track_parameters & alpha = simulated_alphas_.back();
-      alpha.length += (a_hit.get_position_stop() - a_hit.get_position_start()).mag();
+      simulated_alphas_.push_back(alpha);
     }
 
     return;
   }
 
-  void snemo_alpha_delayed_studies_module::_process_reconstructed_alphas(const datatools::things & data_record_,
-                                                                         alpha_list_type & reconstructed_alphas_)
+  void snemo_alpha_delayed_studies_module::_process_reconstructed_alphas(alpha_list_type & reconstructed_alphas_)
   {
-    // Check if some 'topology_data' are available in the data model:
-    const std::string td_label = "TD";//snemo::datamodel::data_info::default_particle_track_data_label();
-    if (! data_record_.has(td_label)) {
+    // Get the 'topology_data' entry from the event view :
+    if (_view_->get_topology_data() == 0) {
       DT_LOG_ERROR(get_logging_priority(), "Missing topology data to be processed !");
       return;
     }
-    const snemo::datamodel::topology_data & td
-      = data_record_.get<snemo::datamodel::topology_data>(td_label);
+    const snemo::datamodel::topology_data & td = *_view_->get_topology_data();
 
     DT_LOG_DEBUG(get_logging_priority(), "Topology data : ");
     if (get_logging_priority() >= datatools::logger::PRIO_DEBUG) td.tree_dump();
 
     if (! td.has_pattern()) return;
-    if (td.has_pattern_as<snemo::datamodel::topology_1e1a_pattern>()) {
+    if (! td.has_pattern_as<snemo::datamodel::topology_1e1a_pattern>()) {
       DT_LOG_WARNING(get_logging_priority(), "Topology pattern does not match '"
                      << snemo::datamodel::topology_1e1a_pattern::pattern_id() << "' topology !");
       return;
     }
     const snemo::datamodel::topology_1e1a_pattern & a_1e1a_pattern
       = td.get_pattern_as<snemo::datamodel::topology_1e1a_pattern>();
-    alpha_track_parameters alpha = {0, 0};
+    alpha_track_parameters alpha = {0, 0, datatools::invalid_real(), datatools::invalid_real(),
+                                    0, datatools::invalid_real()};
     alpha.length = a_1e1a_pattern.get_alpha_track_length();
+    const snemo::datamodel::particle_track & a_alpha = a_1e1a_pattern.get_alpha_track();
 
-    // Store the number of geiger cells associated to alpha track
-    if (! _selected_geiger_range_.empty()) {
-      const snemo::datamodel::particle_track & a_alpha = a_1e1a_pattern.get_alpha_track();
-      if (! a_alpha.has_trajectory()) return;
-      if (! a_alpha.get_trajectory().has_cluster()) return;
+    // Store the number of geiger cells associated to alpha track (an alpha
+    // without cluster keeps 0 cells and is still histogrammed)
+    if (_use_geiger_count_ &&
+        a_alpha.has_trajectory() && a_alpha.get_trajectory().has_cluster()) {
       alpha.nggs = a_alpha.get_trajectory().get_cluster().get_number_of_hits();
     }
 
+    if (_delayed_mode_) {
+      alpha.delayed_time = a_1e1a_pattern.get_alpha_delayed_time();
+
+      // Closest distance between alpha and electron vertices
+      const snemo::datamodel::particle_track & a_electron = a_1e1a_pattern.get_electron_track();
+      if (a_alpha.has_vertices() && a_electron.has_vertices()) {
+        double distance2 = std::numeric_limits<double>::infinity();
+        for (const auto & ialpha : a_alpha.get_vertices()) {
+          const geomtools::vector_3d & a_alpha_vertex = ialpha.get().get_position();
+          for (const auto & ielectron : a_electron.get_vertices()) {
+            const geomtools::vector_3d & a_electron_vertex = ielectron.get().get_position();
+            distance2 = std::min(distance2, (a_alpha_vertex - a_electron_vertex).mag2());
+          }
+        }
+        alpha.vertex_distance = std::sqrt(distance2);
+      }
+
+      // Geiger times of the alpha track give its time spread
+      _geiger_times_.clear();
+      if (_collect_geiger_times_(a_alpha)) {
+        const auto minmax = std::minmax_element(_geiger_times_.begin(), _geiger_times_.end());
+        alpha.time_spread = *minmax.second - *minmax.first;
+      }
+
+      // Geiger times of both tracks are then gathered into clusters
+      _collect_geiger_times_(a_electron);
+      std::sort(_geiger_times_.begin(), _geiger_times_.end());
+      for (size_t i = 0; i < _geiger_times_.size(); i++) {
+        if (i == 0 || _geiger_times_[i] - _geiger_times_[i-1] > _time_cluster_gap_) {
+          alpha.ntime_clusters++;
+        }
+      }
+    }
+
     // Finally push new alpha parameters
     reconstructed_alphas_.push_back(alpha);
     return;
@@ -260,30 +377,123 @@ namespace analysis {
     const alpha_track_parameters & a_sim_alpha = sim_alphas_.front();
     const alpha_track_parameters & a_rec_alpha = rec_alphas_.front();
 
-    std::ostringstream key;
-    key << "1e1a::delta_track_length";
-    if (a_rec_alpha.nggs != 0 && ! _selected_geiger_range_.empty()) {
+    const double ratio = a_rec_alpha.length/a_sim_alpha.length;
+    const double delta = (ratio - 1.0)*100*CLHEP::perCent;
+
+    // Route the number of geiger cells to its histogram
+    const size_t nggs = std::max(a_rec_alpha.nggs, 0);
+    const size_t route = _geiger_routes_[std::min(nggs, _geiger_routes_.size() - 1)];
+    _delta_histograms_[route]->fill(delta);
+    if (_geiger_delta_histogram_ != 0) {
+      _geiger_delta_histogram_->fill(nggs, delta);
+    }
+    return;
+  }
+
+  void snemo_alpha_delayed_studies_module::_compare_delayed_alpha(const alpha_list_type & sim_alphas_,
+                                                                  const alpha_list_type & rec_alphas_)
+  {
+    if (sim_alphas_.size() != 1 || rec_alphas_.size() != 1) {
+      DT_LOG_DEBUG(get_logging_priority(), "Only one alpha is expected !");
+      return;
+    }
+
+    const alpha_track_parameters & a_sim_alpha = sim_alphas_.front();
+    const alpha_track_parameters & a_rec_alpha = rec_alphas_.front();
+
+    if (datatools::is_valid(a_sim_alpha.delayed_time) && datatools::is_valid(a_rec_alpha.delayed_time)) {
+      _delayed_time_histogram_->fill(a_rec_alpha.delayed_time - a_sim_alpha.delayed_time);
+    }
+    if (datatools::is_valid(a_rec_alpha.vertex_distance)) {
+      _vertex_distance_histogram_->fill(a_rec_alpha.vertex_distance);
+    }
+    if (a_rec_alpha.ntime_clusters > 0) {
+      _time_clusters_histogram_->fill(a_rec_alpha.ntime_clusters);
+    }
+    if (datatools::is_valid(a_rec_alpha.time_spread)) {
+      _time_spread_histogram_->fill(a_rec_alpha.time_spread);
+    }
+    return;
+  }
+
+  bool snemo_alpha_delayed_studies_module::_collect_geiger_times_(const snemo::datamodel::particle_track & particle_)
+  {
+    if (! particle_.has_trajectory()) return false;
+    if (! particle_.get_trajectory().has_cluster()) return false;
+    const snemo::datamodel::calibrated_tracker_hit::collection_type & the_hits
+      = particle_.get_trajectory().get_cluster().get_hits();
+    if (the_hits.empty()) return false;
+    for (const auto & ihit : the_hits) {
+      // Prompt geiger cells are set at the electron time
+      const snemo::datamodel::calibrated_tracker_hit & a_hit = ihit.get();
+      _geiger_times_.push_back(a_hit.is_delayed() ? a_hit.get_delayed_time() : 0.0);
+    }
+    return true;
+  }
+
+  void snemo_alpha_delayed_studies_module::_build_geiger_routes_()
+  {
+    static const std::string delta_key = "1e1a::delta_track_length";
+    static const std::string delta_template = "1e1a::delta_template";
+    _delta_histograms_.clear();
+    _geiger_routes_.clear();
+    _delta_histograms_.push_back(&_grab_histogram_1d_(delta_key, delta_template));
+    _geiger_routes_.push_back(0);
+    if (_selected_geiger_range_.empty()) return;
+
+    // Histogram keys are computed once for every number of geiger cells up to
+    // the largest range, larger numbers sharing the last route
+    const int max_range = *std::max_element(_selected_geiger_range_.begin(),
+                                            _selected_geiger_range_.end());
+    std::map<std::string, size_t> indices;
+    for (int n = 1; n <= std::max(max_range, 0) + 1; n++) {
+      std::ostringstream key;
+      key << delta_key;
       for (auto i : _selected_geiger_range_) {
-        if (a_rec_alpha.nggs <= i) {
+        if (n <= i) {
           key << "_<=" << i << "gg";
           break;
         } else if (i == _selected_geiger_range_.back()) {
           key << "_>" << i << "gg";
         }
       }
+      if (! indices.count(key.str())) {
+        indices[key.str()] = _delta_histograms_.size();
+        _delta_histograms_.push_back(&_grab_histogram_1d_(key.str(), delta_template));
+      }
+      _geiger_routes_.push_back(indices[key.str()]);
     }
+    return;
+  }
+
+  mygsl::histogram_1d &
+  snemo_alpha_delayed_studies_module::_grab_histogram_1d_(const std::string & key_,
+                                                          const std::string & template_)
+  {
     mygsl::histogram_pool & a_pool = grab_histogram_pool();
-    if (! a_pool.has_1d(key.str())) {
-      mygsl::histogram_1d & h = a_pool.add_1d(key.str(), "", "1e1a::histos");
+    if (! a_pool.has_1d(key_)) {
+      mygsl::histogram_1d & h = a_pool.add_1d(key_, "", "1e1a::histos");
       datatools::properties hconfig;
       hconfig.store_string("mode", "mimic");
-      hconfig.store_string("mimic.histogram_1d", "1e1a::delta_template");
+      hconfig.store_string("mimic.histogram_1d", template_);
       mygsl::histogram_pool::init_histo_1d(h, hconfig, &a_pool);
     }
-    mygsl::histogram_1d & h1d = a_pool.grab_1d(key.str());
-    const double ratio = a_rec_alpha.length/a_sim_alpha.length;
-    h1d.fill((ratio - 1.0)*100*CLHEP::perCent);
-    return;
+    return a_pool.grab_1d(key_);
+  }
+
+  mygsl::histogram_2d &
+  snemo_alpha_delayed_studies_module::_grab_histogram_2d_(const std::string & key_,
+                                                          const std::string & template_)
+  {
+    mygsl::histogram_pool & a_pool = grab_histogram_pool();
+    if (! a_pool.has_2d(key_)) {
+      mygsl::histogram_2d & h = a_pool.add_2d(key_, "", "1e1a::histos");
+      datatools::properties hconfig;
+      hconfig.store_string("mode", "mimic");
+      hconfig.store_string("mimic.histogram_2d", template_);
+      mygsl::histogram_pool::init_histo_2d(h, hconfig, &a_pool);
+    }
+    return a_pool.grab_2d(key_);
   }
 
 } // namespace analysis
@@ -36,9 +36,20 @@
 // Data processing module abstract base class
 #include <dpp/base_module.h>
 
+// This project:
+#include <event_view.h>
+
 // Forward declaration
+namespace snemo {
+  namespace datamodel {
+    class particle_track;
+  }
+}
+
 namespace mygsl {
   class histogram_pool;
+  class histogram_1d;
+  class histogram_2d;
 }
 
 namespace snemo {
@@ -52,6 +63,10 @@ namespace analysis {
     struct alpha_track_parameters {
       double length;
       int nggs;
+      double delayed_time;    //!< Alpha emission time after the electron
+      double vertex_distance; //!< Closest distance between alpha and electron vertices
+      size_t ntime_clusters;  //!< Number of geiger time clusters
+      double time_spread;     //!< Time spread of alpha geiger cells
     };
 
     /// Typedef for a list of alpha tracks
@@ -89,20 +104,58 @@ namespace analysis {
     void _set_defaults();
 
     /// Get alphas simulated parameters from 'simulated_data' bank
-    void _process_simulated_alphas(const datatools::things & data_, alpha_list_type & alphas_);
+    void _process_simulated_alphas(alpha_list_type & alphas_);
 
     /// Get alphas reconstructed parameters from 'topology_data' bank
-    void _process_reconstructed_alphas(const datatools::things & data_, alpha_list_type & alphas_);
+    void _process_reconstructed_alphas(alpha_list_type & alphas_);
 
     /// Compare alpha track length
     void _compare_track_length(const alpha_list_type & sim_alphas_,
                                const alpha_list_type & rec_alphas_);
 
+    /// Compare alpha delayed time and plot vertex association and geiger timing
+    void _compare_delayed_alpha(const alpha_list_type & sim_alphas_,
+                                const alpha_list_type & rec_alphas_);
+
+    /// Collect geiger times of a particle track (return false if no cluster)
+    bool _collect_geiger_times_(const snemo::datamodel::particle_track & particle_);
+
+    /// Create the track length histograms and route Geiger ranges to them
+    void _build_geiger_routes_();
+
+    /// Grab a 1D histogram given its key, creating it from a template if needed
+    mygsl::histogram_1d & _grab_histogram_1d_(const std::string & key_, const std::string & template_);
+
+    /// Grab a 2D histogram given its key, creating it from a template if needed
+    mygsl::histogram_2d & _grab_histogram_2d_(const std::string & key_, const std::string & template_);
+
   private:
 
     mygsl::histogram_pool * _histogram_pool_;  //!< Histogram pool
 
     std::vector<int> _selected_geiger_range_; //!< Selection of alpha track with given geiger number
+    bool _use_geiger_count_;                  //!< Flag to count geiger cells of alpha tracks
+
+    std::vector<mygsl::histogram_1d *> _delta_histograms_; //!< Track length histograms by Geiger range
+    std::vector<size_t> _geiger_routes_;                   //!< Histogram index by number of geiger cells
+    mygsl::histogram_2d * _geiger_delta_histogram_;        //!< Track length vs. number of geiger cells
+
+    event_view * _view_;             //!< Event view of the current record (shared or owned by the module)
+    event_view _local_view_;         //!< Event view owned by the module
+    event_view * _shared_view_;      //!< Event view of the 'EventView' service (optional)
+    uint64_t _shared_view_serial_;   //!< Serial of the shared view at the previous call
+    bool _shared_view_checked_;      //!< Flag set once the shared view has been checked
+
+    alpha_list_type _simulated_alphas_;     //!< Simulated alphas of the current event
+    alpha_list_type _reconstructed_alphas_; //!< Reconstructed alphas of the current event
+
+    bool _delayed_mode_;                    //!< Flag for delayed alpha timing studies
+    double _time_cluster_gap_;              //!< Time gap between two geiger time clusters
+    std::vector<double> _geiger_times_;     //!< Geiger times of the current event
+    mygsl::histogram_1d * _delayed_time_histogram_;    //!< Delayed time residual
+    mygsl::histogram_1d * _vertex_distance_histogram_; //!< Alpha/electron vertex distance
+    mygsl::histogram_1d * _time_clusters_histogram_;   //!< Number of geiger time clusters
+    mygsl::histogram_1d * _time_spread_histogram_;     //!< Time spread of alpha geiger cells
 
     // Macro to automate the registration of the module :
     DPP_MODULE_REGISTRATION_INTERFACE(snemo_alpha_delayed_studies_module);
@@ -0,0 +1,279 @@
+/// bremsstrahlung_ntuple.cc
+
+// Ourselves:
+#include <bremsstrahlung_ntuple.h>
+
+// Standard library:
+#include <stdexcept>
+#include <cstring>
+#include <utility>
+
+// Third party:
+// - Bayeux/datatools:
+#include <datatools/exception.h>
+
+namespace analysis {
+
+  namespace {
+
+    /// File signature
+    const char MAGIC[8] = { 'S', 'N', 'B', 'R', 'E', 'M', '0', '2' };
+
+    /// Write a column
+    template <typename T>
+    void write_column(std::ostream & out_, const std::vector<T> & column_)
+    {
+      if (column_.empty()) return;
+      out_.write(reinterpret_cast<const char *>(&column_[0]), column_.size() * sizeof(T));
+      return;
+    }
+
+    /// Append n values read from a stream to a column
+    template <typename T>
+    void read_column(std::istream & in_, std::vector<T> & column_, const uint64_t n_)
+    {
+      if (n_ == 0) return;
+      const size_t offset = column_.size();
+      column_.resize(offset + n_);
+      in_.read(reinterpret_cast<char *>(&column_[offset]), n_ * sizeof(T));
+      return;
+    }
+
+  }
+
+  void bremsstrahlung_ntuple::event_type::clear()
+  {
+    electron_energies.clear();
+    electron_particles.clear();
+    gamma_energies.clear();
+    gamma_angles.clear();
+    angle_particles.clear();
+    angle_gammas.clear();
+    vertices.clear();
+    vertex_particles.clear();
+    return;
+  }
+
+  size_t bremsstrahlung_ntuple::block_type::size() const
+  {
+    return nelectrons.size();
+  }
+
+  void bremsstrahlung_ntuple::block_type::clear()
+  {
+    nelectrons.clear();
+    ngammas.clear();
+    nangles.clear();
+    nvertices.clear();
+    electron_particle.clear();
+    angle_particle.clear();
+    angle_gamma.clear();
+    vertex_particle.clear();
+    electron_energy.clear();
+    gamma_energy.clear();
+    gamma_angle.clear();
+    vertex_x.clear();
+    vertex_y.clear();
+    vertex_z.clear();
+    return;
+  }
+
+  bremsstrahlung_ntuple::bremsstrahlung_ntuple()
+  {
+    _block_size_  = 0;
+    _has_pending_ = false;
+    _stop_        = false;
+    return;
+  }
+
+  bremsstrahlung_ntuple::~bremsstrahlung_ntuple()
+  {
+    if (is_open()) {
+      try {
+        close();
+      } catch (...) {
+        // Nothing can be done about a failed write at this point
+      }
+    }
+    return;
+  }
+
+  void bremsstrahlung_ntuple::open(const std::string & filename_, const size_t block_size_)
+  {
+    DT_THROW_IF(is_open(), std::logic_error, "Ntuple file '" << _filename_ << "' is already open !");
+    DT_THROW_IF(block_size_ == 0, std::logic_error, "Block size must be positive !");
+    _fout_.open(filename_.c_str(), std::ios::binary | std::ios::trunc);
+    DT_THROW_IF(! _fout_, std::runtime_error, "Cannot open file '" << filename_ << "' !");
+    _fout_.write(MAGIC, sizeof(MAGIC));
+    _filename_    = filename_;
+    _block_size_  = block_size_;
+    _has_pending_ = false;
+    _stop_        = false;
+    _error_.clear();
+    _current_.clear();
+    _writer_ = std::thread(&bremsstrahlung_ntuple::_write_loop_, this);
+    return;
+  }
+
+  bool bremsstrahlung_ntuple::is_open() const
+  {
+    return _writer_.joinable();
+  }
+
+  void bremsstrahlung_ntuple::fill(const event_type & event_)
+  {
+    DT_THROW_IF(! is_open(), std::logic_error, "Ntuple is not open !");
+    // Check the event before touching the block so a rejected event never
+    // leaves multiplicities without their values
+    DT_THROW_IF(event_.electron_particles.size() != event_.electron_energies.size() ||
+                event_.angle_particles.size() != event_.gamma_angles.size() ||
+                event_.angle_gammas.size() != event_.gamma_angles.size() ||
+                event_.vertex_particles.size() != event_.vertices.size(),
+                std::logic_error, "Missing particle or gamma indexes !");
+    _current_.nelectrons.push_back(event_.electron_energies.size());
+    _current_.ngammas.push_back(event_.gamma_energies.size());
+    _current_.nangles.push_back(event_.gamma_angles.size());
+    _current_.nvertices.push_back(event_.vertices.size());
+    for (size_t i = 0; i < event_.electron_energies.size(); i++) {
+      _current_.electron_energy.push_back(event_.electron_energies[i]);
+      _current_.electron_particle.push_back(event_.electron_particles[i]);
+    }
+    for (size_t i = 0; i < event_.gamma_energies.size(); i++) {
+      _current_.gamma_energy.push_back(event_.gamma_energies[i]);
+    }
+    for (size_t i = 0; i < event_.gamma_angles.size(); i++) {
+      _current_.gamma_angle.push_back(event_.gamma_angles[i]);
+      _current_.angle_particle.push_back(event_.angle_particles[i]);
+      _current_.angle_gamma.push_back(event_.angle_gammas[i]);
+    }
+    for (size_t i = 0; i < event_.vertices.size(); i++) {
+      _current_.vertex_x.push_back(event_.vertices[i].x());
+      _current_.vertex_y.push_back(event_.vertices[i].y());
+      _current_.vertex_z.push_back(event_.vertices[i].z());
+      _current_.vertex_particle.push_back(event_.vertex_particles[i]);
+    }
+    if (_current_.size() >= _block_size_) _flush_();
+    return;
+  }
+
+  void bremsstrahlung_ntuple::close()
+  {
+    if (! is_open()) return;
+    // The writer thread is always stopped, even if the last block can not be handed over
+    std::string an_error;
+    if (_current_.size() > 0) {
+      try {
+        _flush_();
+      } catch (std::exception & error_) {
+        an_error = error_.what();
+      }
+    }
+    {
+      std::lock_guard<std::mutex> lock(_mutex_);
+      _stop_ = true;
+    }
+    _condition_.notify_all();
+    _writer_.join();
+    _fout_.close();
+    _current_.clear();
+    if (an_error.empty()) an_error = _error_;
+    DT_THROW_IF(! an_error.empty(), std::runtime_error, an_error);
+    return;
+  }
+
+  void bremsstrahlung_ntuple::_flush_()
+  {
+    std::unique_lock<std::mutex> lock(_mutex_);
+    // Wait for the previous block to be written
+    _condition_.wait(lock, [this] () { return ! _has_pending_; });
+    DT_THROW_IF(! _error_.empty(), std::runtime_error, _error_);
+    std::swap(_current_, _pending_);
+    _current_.clear();
+    _has_pending_ = true;
+    lock.unlock();
+    _condition_.notify_all();
+    return;
+  }
+
+  void bremsstrahlung_ntuple::_write_loop_()
+  {
+    std::unique_lock<std::mutex> lock(_mutex_);
+    while (true) {
+      _condition_.wait(lock, [this] () { return _has_pending_ || _stop_; });
+      if (! _has_pending_) break;
+      // The pending block is not touched by the filling thread until released
+      lock.unlock();
+      const uint64_t header[5] = {
+        _pending_.size(),
+        _pending_.electron_energy.size(),
+        _pending_.gamma_energy.size(),
+        _pending_.gamma_angle.size(),
+        _pending_.vertex_x.size()
+      };
+      _fout_.write(reinterpret_cast<const char *>(header), sizeof(header));
+      write_column(_fout_, _pending_.nelectrons);
+      write_column(_fout_, _pending_.ngammas);
+      write_column(_fout_, _pending_.nangles);
+      write_column(_fout_, _pending_.nvertices);
+      write_column(_fout_, _pending_.electron_particle);
+      write_column(_fout_, _pending_.angle_particle);
+      write_column(_fout_, _pending_.angle_gamma);
+      write_column(_fout_, _pending_.vertex_particle);
+      write_column(_fout_, _pending_.electron_energy);
+      write_column(_fout_, _pending_.gamma_energy);
+      write_column(_fout_, _pending_.gamma_angle);
+      write_column(_fout_, _pending_.vertex_x);
+      write_column(_fout_, _pending_.vertex_y);
+      write_column(_fout_, _pending_.vertex_z);
+      const bool failed = ! _fout_;
+      lock.lock();
+      if (failed && _error_.empty()) {
+        _error_ = "Writing into file '" + _filename_ + "' fails !";
+      }
+      _has_pending_ = false;
+      _condition_.notify_all();
+    }
+    return;
+  }
+
+  void bremsstrahlung_ntuple::load(const std::string & filename_, block_type & data_)
+  {
+    std::ifstream fin(filename_.c_str(), std::ios::binary);
+    DT_THROW_IF(! fin, std::runtime_error, "Cannot open file '" << filename_ << "' !");
+    char magic[sizeof(MAGIC)];
+    fin.read(magic, sizeof(magic));
+    DT_THROW_IF(! fin || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0, std::runtime_error,
+                "File '" << filename_ << "' is not a bremsstrahlung ntuple !");
+    data_.clear();
+    uint64_t header[5];
+    while (fin.read(reinterpret_cast<char *>(header), sizeof(header))) {
+      read_column(fin, data_.nelectrons,        header[0]);
+      read_column(fin, data_.ngammas,           header[0]);
+      read_column(fin, data_.nangles,           header[0]);
+      read_column(fin, data_.nvertices,         header[0]);
+      read_column(fin, data_.electron_particle, header[1]);
+      read_column(fin, data_.angle_particle,    header[3]);
+      read_column(fin, data_.angle_gamma,       header[3]);
+      read_column(fin, data_.vertex_particle,   header[4]);
+      read_column(fin, data_.electron_energy,   header[1]);
+      read_column(fin, data_.gamma_energy,      header[2]);
+      read_column(fin, data_.gamma_angle,       header[3]);
+      read_column(fin, data_.vertex_x,          header[4]);
+      read_column(fin, data_.vertex_y,          header[4]);
+      read_column(fin, data_.vertex_z,          header[4]);
+      DT_THROW_IF(! fin, std::runtime_error, "File '" << filename_ << "' is truncated !");
+    }
+    DT_THROW_IF(fin.gcount() != 0, std::runtime_error, "File '" << filename_ << "' is truncated !");
+    return;
+  }
+
+} // namespace analysis
+
+// end of bremsstrahlung_ntuple.cc
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
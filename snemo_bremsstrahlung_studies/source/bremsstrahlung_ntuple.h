@@ -0,0 +1,160 @@
+/// \file bremsstrahlung_ntuple.h
+/* Author(s)     : Xavier Garrido <garrido@lal.in2p3.fr>
+ * Creation date : 2026-10-18
+ * Last modified : 2026-10-18
+ *
+ * Copyright (C) 2026 Xavier Garrido <garrido@lal.in2p3.fr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * Description:
+ *
+ *   Columnar per-event ntuple of bremsstrahlung observables. Events are
+ *   buffered into blocks which are written by a background thread while the
+ *   next block is being filled. Variable length quantities are stored as
+ *   flat columns together with their per-event multiplicities. Electron
+ *   energies, angles and vertices come with the index of their particle in
+ *   the event (and angles with the index of their gamma) so that per particle
+ *   selections can be applied when reading the file back.
+ *
+ *   File layout: the "SNBREM02" signature followed by blocks made of the
+ *   number of events, the number of entries of each flat column, the
+ *   multiplicity columns (uint32), the index columns (uint32) and the value
+ *   columns (float32).
+ *
+ * History:
+ *
+ */
+
+#ifndef ANALYSIS_BREMSSTRAHLUNG_NTUPLE_H
+#define ANALYSIS_BREMSSTRAHLUNG_NTUPLE_H 1
+
+// Standard library:
+#include <string>
+#include <vector>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <stdint.h>
+
+// Third party:
+// - Bayeux/geomtools:
+#include <geomtools/clhep.h>
+
+namespace analysis {
+
+  /// \brief Columnar ntuple of bremsstrahlung events
+  class bremsstrahlung_ntuple
+  {
+  public:
+
+    /// Observables of one event
+    struct event_type
+    {
+      std::vector<double>               electron_energies;  //!< Energies of electrons
+      std::vector<uint32_t>             electron_particles; //!< Particle indexes of electron energies
+      std::vector<double>               gamma_energies;     //!< Energies of non associated calorimeters
+      std::vector<double>               gamma_angles;       //!< Electron/gamma angles
+      std::vector<uint32_t>             angle_particles;    //!< Particle indexes of angles
+      std::vector<uint32_t>             angle_gammas;       //!< Gamma indexes of angles
+      std::vector<geomtools::vector_3d> vertices;           //!< Foil vertices
+      std::vector<uint32_t>             vertex_particles;   //!< Particle indexes of vertices
+      /// Reset the event without releasing memory
+      void clear();
+    };
+
+    /// Columns of a block of events
+    struct block_type
+    {
+      std::vector<uint32_t> nelectrons;
+      std::vector<uint32_t> ngammas;
+      std::vector<uint32_t> nangles;
+      std::vector<uint32_t> nvertices;
+      std::vector<uint32_t> electron_particle;
+      std::vector<uint32_t> angle_particle;
+      std::vector<uint32_t> angle_gamma;
+      std::vector<uint32_t> vertex_particle;
+      std::vector<float>    electron_energy;
+      std::vector<float>    gamma_energy;
+      std::vector<float>    gamma_angle;
+      std::vector<float>    vertex_x;
+      std::vector<float>    vertex_y;
+      std::vector<float>    vertex_z;
+      /// Return the number of events
+      size_t size() const;
+      /// Remove all events without releasing memory
+      void clear();
+    };
+
+    /// Default constructor
+    bremsstrahlung_ntuple();
+
+    /// Destructor
+    ~bremsstrahlung_ntuple();
+
+    /// Open a file for writing
+    void open(const std::string & filename_, const size_t block_size_ = 10000);
+
+    /// Check if a file is open for writing
+    bool is_open() const;
+
+    /// Add an event
+    void fill(const event_type & event_);
+
+    /// Write the remaining events and close the file
+    void close();
+
+    /// Read all events of a file
+    static void load(const std::string & filename_, block_type & data_);
+
+  private:
+
+    /// Not copyable
+    bremsstrahlung_ntuple(const bremsstrahlung_ntuple &);
+    bremsstrahlung_ntuple & operator=(const bremsstrahlung_ntuple &);
+
+    /// Hand the current block to the writer thread
+    void _flush_();
+
+    /// Writer thread loop
+    void _write_loop_();
+
+    size_t                  _block_size_;    //!< Number of events per block
+    block_type              _current_;       //!< Block being filled
+    block_type              _pending_;       //!< Block being written
+    bool                    _has_pending_;   //!< Flag for a block waiting to be written
+    bool                    _stop_;          //!< Flag to stop the writer thread
+    std::string             _error_;         //!< Error message of the writer thread
+    std::string             _filename_;      //!< Output file name
+    std::ofstream           _fout_;          //!< Output file
+    std::thread             _writer_;        //!< Writer thread
+    std::mutex              _mutex_;         //!< Lock of the pending block
+    std::condition_variable _condition_;     //!< Pending block notification
+
+  };
+
+} // namespace analysis
+
+#endif // ANALYSIS_BREMSSTRAHLUNG_NTUPLE_H
+
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
@@ -0,0 +1,252 @@
+/// calorimeter_block_table.cc
+
+// Ourselves:
+#include <calorimeter_block_table.h>
+
+// Standard library:
+#include <stdexcept>
+#include <algorithm>
+#include <string>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <vector>
+
+// POSIX:
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Third party:
+// - Bayeux/datatools:
+#include <datatools/exception.h>
+#include <datatools/logger.h>
+// - Bayeux/geomtools:
+#include <geomtools/manager.h>
+#include <geomtools/id_mgr.h>
+#include <geomtools/mapping.h>
+
+// Geometry manager
+#include <falaise/snemo/geometry/locator_plugin.h>
+#include <falaise/snemo/geometry/calo_locator.h>
+#include <falaise/snemo/geometry/xcalo_locator.h>
+#include <falaise/snemo/geometry/gveto_locator.h>
+
+namespace analysis {
+
+  namespace {
+
+    /// Cache file signature
+    const char MAGIC[8] = { 'S', 'N', 'C', 'A', 'L', 'O', '0', '1' };
+
+    /// Size of the cache header (signature + label/version sizes + number of blocks)
+    const size_t HEADER_SIZE = sizeof(MAGIC) + 3 * sizeof(uint64_t);
+
+    /// Round a size to the next multiple of 8 bytes
+    size_t align_8(const size_t size_)
+    {
+      return (size_ + 7) & ~size_t(7);
+    }
+
+  }
+
+  calorimeter_block_table::calorimeter_block_table()
+  {
+    return;
+  }
+
+  uint64_t calorimeter_block_table::make_key(const geomtools::geom_id & gid_)
+  {
+    // The type is stored in the upper 24 bits and the address, without the
+    // last item (the block part), in 8 bits items
+    const size_t depth = gid_.get_depth();
+    if (depth < 1 || depth > 6 || gid_.get_type() >= (1u << 24)) return 0;
+    uint64_t key = static_cast<uint64_t>(gid_.get_type()) << 40;
+    for (size_t i = 0; i + 1 < depth; i++) {
+      const uint32_t item = gid_.get(i);
+      if (item > 0xFF) return 0;
+      key |= static_cast<uint64_t>(item) << (8 * (4 - i));
+    }
+    return key;
+  }
+
+  void calorimeter_block_table::build(const geomtools::manager & geo_mgr_,
+                                      const snemo::geometry::locator_plugin & locator_)
+  {
+    clear();
+    const geomtools::id_mgr & an_id_mgr = geo_mgr_.get_id_mgr();
+    const char * categories[3] = { "calorimeter_block", "xcalo_block", "gveto_block" };
+    int types[3];
+    for (size_t i = 0; i < 3; i++) {
+      DT_THROW_IF(! an_id_mgr.has_category_info(categories[i]), std::logic_error,
+                  "Unknown geometry category '" << categories[i] << "' !");
+      types[i] = an_id_mgr.get_category_info(categories[i]).get_type();
+    }
+
+    const snemo::geometry::calo_locator & calo_locator   = locator_.get_calo_locator();
+    const snemo::geometry::xcalo_locator & xcalo_locator = locator_.get_xcalo_locator();
+    const snemo::geometry::gveto_locator & gveto_locator = locator_.get_gveto_locator();
+    std::vector<std::pair<uint64_t, geomtools::vector_3d> > blocks;
+    const geomtools::geom_info_dict_type & the_infos = geo_mgr_.get_mapping().get_geom_infos();
+    for (geomtools::geom_info_dict_type::const_iterator i = the_infos.begin();
+         i != the_infos.end(); ++i) {
+      const geomtools::geom_id & a_gid = i->first;
+      if (std::find(types, types + 3, (int)a_gid.get_type()) == types + 3) continue;
+
+      geomtools::vector_3d vblock;
+      geomtools::invalidate(vblock);
+      if (calo_locator.is_calo_block(a_gid)) {
+        calo_locator.get_block_position(a_gid, vblock);
+      } else if (xcalo_locator.is_calo_block(a_gid)) {
+        xcalo_locator.get_block_position(a_gid, vblock);
+      } else if (gveto_locator.is_calo_block(a_gid)) {
+        gveto_locator.get_block_position(a_gid, vblock);
+      }
+      // Blocks from other modules are not handled by the locators
+      if (! geomtools::is_valid(vblock)) continue;
+      const uint64_t key = make_key(a_gid);
+      DT_THROW_IF(key == 0, std::logic_error, "Calorimeter block '" << a_gid << "' can not be indexed !");
+      blocks.push_back(std::make_pair(key, vblock));
+    }
+    DT_THROW_IF(blocks.empty(), std::logic_error,
+                "No calorimeter block has been found in geometry mapping !");
+
+    // Block parts share the same key: keep only one of them
+    std::stable_sort(blocks.begin(), blocks.end(),
+                     [] (const std::pair<uint64_t, geomtools::vector_3d> & a_,
+                         const std::pair<uint64_t, geomtools::vector_3d> & b_) {
+                       return a_.first < b_.first;
+                     });
+    for (size_t i = 0; i < blocks.size(); i++) {
+      if (! _keys_.empty() && _keys_.back() == blocks[i].first) continue;
+      _keys_.push_back(blocks[i].first);
+      _positions_.push_back(blocks[i].second);
+    }
+    return;
+  }
+
+  void calorimeter_block_table::store(const std::string & filename_,
+                                      const std::string & setup_label_,
+                                      const std::string & setup_version_) const
+  {
+    // Write into a temporary file with a unique name first so concurrent jobs
+    // neither share the temporary file nor map a partial cache
+    std::vector<char> tmp_template(filename_.begin(), filename_.end());
+    const std::string suffix = ".XXXXXX";
+    tmp_template.insert(tmp_template.end(), suffix.begin(), suffix.end());
+    tmp_template.push_back('\0');
+    const int fd = ::mkstemp(&tmp_template[0]);
+    DT_THROW_IF(fd < 0, std::runtime_error, "Cannot create a temporary file for '" << filename_ << "' !");
+    ::fchmod(fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    ::close(fd);
+    const std::string tmp_filename(&tmp_template[0]);
+    {
+      std::ofstream fout(tmp_filename.c_str(), std::ios::binary | std::ios::trunc);
+      if (! fout) std::remove(tmp_filename.c_str());
+      DT_THROW_IF(! fout, std::runtime_error, "Cannot open file '" << tmp_filename << "' !");
+      const uint64_t header[3] = { setup_label_.size(), setup_version_.size(), _keys_.size() };
+      fout.write(MAGIC, sizeof(MAGIC));
+      fout.write(reinterpret_cast<const char *>(header), sizeof(header));
+      fout.write(setup_label_.data(), setup_label_.size());
+      fout.write(setup_version_.data(), setup_version_.size());
+      const size_t nstrings = setup_label_.size() + setup_version_.size();
+      const char padding[8] = { 0 };
+      fout.write(padding, align_8(nstrings) - nstrings);
+      if (! _keys_.empty()) {
+        fout.write(reinterpret_cast<const char *>(&_keys_[0]), _keys_.size() * sizeof(uint64_t));
+      }
+      for (size_t i = 0; i < _positions_.size(); i++) {
+        const double xyz[3] = { _positions_[i].x(), _positions_[i].y(), _positions_[i].z() };
+        fout.write(reinterpret_cast<const char *>(xyz), sizeof(xyz));
+      }
+      fout.close();
+      if (! fout) std::remove(tmp_filename.c_str());
+      DT_THROW_IF(! fout, std::runtime_error, "Cannot write file '" << tmp_filename << "' !");
+    }
+    DT_THROW_IF(std::rename(tmp_filename.c_str(), filename_.c_str()) != 0, std::runtime_error,
+                "Cannot rename file '" << tmp_filename << "' into '" << filename_ << "' !");
+    return;
+  }
+
+  bool calorimeter_block_table::load(const std::string & filename_,
+                                     const std::string & setup_label_,
+                                     const std::string & setup_version_,
+                                     datatools::logger::priority priority_)
+  {
+    // A missing, stale or broken cache is not an error: the table is then
+    // built from the geometry and the cache is rewritten
+    const int fd = ::open(filename_.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    const bool has_size = ::fstat(fd, &st) == 0 && st.st_size >= (off_t)HEADER_SIZE;
+    void * address = has_size ? ::mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    ::close(fd);
+    if (address == MAP_FAILED) {
+      DT_LOG_WARNING(priority_,
+                     "File '" << filename_ << "' is not a valid calorimeter block cache !");
+      return false;
+    }
+    const char * data = static_cast<const char *>(address);
+    const size_t nbytes = st.st_size;
+
+    bool loaded = false;
+    uint64_t header[3];
+    std::memcpy(header, data + sizeof(MAGIC), sizeof(header));
+    const size_t nstrings = header[0] + header[1];
+    if (std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0) {
+      DT_LOG_WARNING(priority_,
+                     "File '" << filename_ << "' is not a calorimeter block cache !");
+    } else if (header[0] > nbytes || header[1] > nbytes || header[2] > nbytes ||
+               nbytes != HEADER_SIZE + align_8(nstrings) + header[2] * (sizeof(uint64_t) + 3 * sizeof(double))) {
+      DT_LOG_WARNING(priority_,
+                     "File '" << filename_ << "' is truncated !");
+    } else if (setup_label_.compare(0, std::string::npos, data + HEADER_SIZE, header[0]) == 0 &&
+               setup_version_.compare(0, std::string::npos, data + HEADER_SIZE + header[0], header[1]) == 0) {
+      // Keys and positions are stored as contiguous 8 bytes aligned arrays
+      const uint64_t * keys = reinterpret_cast<const uint64_t *>(data + HEADER_SIZE + align_8(nstrings));
+      const double * xyz = reinterpret_cast<const double *>(keys + header[2]);
+      clear();
+      _keys_.assign(keys, keys + header[2]);
+      _positions_.reserve(header[2]);
+      for (size_t i = 0; i < header[2]; i++, xyz += 3) {
+        _positions_.push_back(geomtools::vector_3d(xyz[0], xyz[1], xyz[2]));
+      }
+      loaded = ! _keys_.empty();
+    }
+    ::munmap(address, nbytes);
+    return loaded;
+  }
+
+  size_t calorimeter_block_table::size() const
+  {
+    return _keys_.size();
+  }
+
+  void calorimeter_block_table::clear()
+  {
+    _keys_.clear();
+    _positions_.clear();
+    return;
+  }
+
+  const geomtools::vector_3d * calorimeter_block_table::get_position(const geomtools::geom_id & gid_) const
+  {
+    const uint64_t key = make_key(gid_);
+    const std::vector<uint64_t>::const_iterator found
+      = std::lower_bound(_keys_.begin(), _keys_.end(), key);
+    if (key == 0 || found == _keys_.end() || *found != key) return 0;
+    return &_positions_[found - _keys_.begin()];
+  }
+
+} // namespace analysis
+
+// end of calorimeter_block_table.cc
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
@@ -0,0 +1,115 @@
+/// \file calorimeter_block_table.h
+/* Author(s)     : Xavier Garrido <garrido@lal.in2p3.fr>
+ * Creation date : 2026-10-18
+ * Last modified : 2026-10-18
+ *
+ * Copyright (C) 2026 Xavier Garrido <garrido@lal.in2p3.fr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * Description:
+ *
+ *   Table of calorimeter block positions (main wall, X-wall and gamma veto)
+ *   built once from the geometry mapping. Blocks are identified by their
+ *   geometry type and address regardless of the block part. The table can be
+ *   stored into a cache file keyed by the geometry setup label and version so
+ *   later jobs can load it without building the geometry.
+ *
+ * History:
+ *
+ */
+
+#ifndef ANALYSIS_CALORIMETER_BLOCK_TABLE_H
+#define ANALYSIS_CALORIMETER_BLOCK_TABLE_H 1
+
+// Standard library:
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+// Third party:
+// - Bayeux/datatools:
+#include <datatools/logger.h>
+// - Bayeux/geomtools:
+#include <geomtools/clhep.h>
+
+namespace geomtools {
+  class manager;
+  class geom_id;
+}
+
+namespace snemo {
+  namespace geometry {
+    class locator_plugin;
+  }
+}
+
+namespace analysis {
+
+  /// \brief Table of calorimeter block positions
+  class calorimeter_block_table
+  {
+  public:
+
+    /// Default constructor
+    calorimeter_block_table();
+
+    /// Build the table from the geometry mapping and the calorimeter locators
+    void build(const geomtools::manager & geo_mgr_,
+               const snemo::geometry::locator_plugin & locator_);
+
+    /// Store the table into a cache file for a given geometry setup
+    void store(const std::string & filename_,
+               const std::string & setup_label_,
+               const std::string & setup_version_) const;
+
+    /// Load the table from a cache file (false if missing, invalid or for another setup,
+    /// problems being logged with the given priority)
+    bool load(const std::string & filename_,
+              const std::string & setup_label_,
+              const std::string & setup_version_,
+              datatools::logger::priority priority_);
+
+    /// Return the number of blocks
+    size_t size() const;
+
+    /// Remove all blocks
+    void clear();
+
+    /// Return the position of a block (0 if the geom_id is not a calorimeter block)
+    const geomtools::vector_3d * get_position(const geomtools::geom_id & gid_) const;
+
+    /// Build the key of a block geom_id (0 if it can not be packed)
+    static uint64_t make_key(const geomtools::geom_id & gid_);
+
+  private:
+
+    std::vector<uint64_t>             _keys_;      //!< Sorted block keys
+    std::vector<geomtools::vector_3d> _positions_; //!< Block positions
+
+  };
+
+} // namespace analysis
+
+#endif // ANALYSIS_CALORIMETER_BLOCK_TABLE_H
+
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
@@ -7,11 +7,14 @@
 #include <stdexcept>
 #include <sstream>
 #include <numeric>
+#include <algorithm>
+#include <cmath>
 
 // Third party:
 // - Bayeux/datatools:
 #include <datatools/clhep_units.h>
 #include <datatools/service_manager.h>
+#include <datatools/utils.h>
 // - Bayeux/geomtools:
 #include <geomtools/geometry_service.h>
 #include <geomtools/manager.h>
@@ -25,9 +28,6 @@
 
 // Geometry manager
 #include <falaise/snemo/geometry/locator_plugin.h>
-#include <falaise/snemo/geometry/calo_locator.h>
-#include <falaise/snemo/geometry/xcalo_locator.h>
-#include <falaise/snemo/geometry/gveto_locator.h>
 
 // SuperNEMO event model
 #include <snemo/datamodels/data_model.h>
@@ -36,6 +36,38 @@
 
 namespace analysis {
 
+  namespace {
+
+    /// Compute the angles between a direction and the vectors going from an
+    /// origin to a set of positions
+    void compute_angles(const size_t n_,
+                        const double * xs_, const double * ys_, const double * zs_,
+                        const geomtools::vector_3d & origin_,
+                        const geomtools::vector_3d & direction_,
+                        double * angles_)
+    {
+      const double dx = direction_.x();
+      const double dy = direction_.y();
+      const double dz = direction_.z();
+      const double d2 = direction_.mag2();
+      // Cosine computation is kept apart from acos so that it can be vectorized.
+      // As in CLHEP Hep3Vector::angle, a null vector gives a null cosine (pi/2)
+      for (size_t i = 0; i < n_; i++) {
+        const double px = xs_[i] - origin_.x();
+        const double py = ys_[i] - origin_.y();
+        const double pz = zs_[i] - origin_.z();
+        const double ptot2 = d2 * (px * px + py * py + pz * pz);
+        const double arg = (dx * px + dy * py + dz * pz) / std::sqrt(ptot2);
+        angles_[i] = ptot2 > 0.0 ? std::max(-1.0, std::min(1.0, arg)) : 0.0;
+      }
+      for (size_t i = 0; i < n_; i++) {
+        angles_[i] = std::acos(angles_[i]);
+      }
+      return;
+    }
+
+  }
+
   // Registration instantiation macro :
   DPP_MODULE_REGISTRATION_IMPLEMENT(snemo_bremsstrahlung_module,
                                     "analysis::snemo_bremsstrahlung_module");
@@ -60,6 +92,8 @@ namespace analysis {
   void snemo_bremsstrahlung_module::_set_defaults ()
   {
     _histogram_pool_ = 0;
+    _locator_plugin_ = 0;
+    _calo_blocks_.clear();
     return;
   }
 
@@ -121,45 +155,93 @@ namespace analysis {
       }
     }
 
-    // Geometry manager :
-    std::string geo_label = snemo::processing::service_info::default_geometry_service_label();
-    if (config_.has_key("Geo_label")) {
-      geo_label = config_.fetch_string("Geo_label");
+    // Per event ntuple
+    if (config_.has_key("ntuple.output_file")) {
+      std::string ntuple_filename = config_.fetch_string("ntuple.output_file");
+      datatools::fetch_path_with_env(ntuple_filename);
+      size_t block_size = 10000;
+      if (config_.has_key("ntuple.block_size")) {
+        block_size = config_.fetch_integer("ntuple.block_size");
+      }
+      _ntuple_.open(ntuple_filename, block_size);
     }
-    DT_THROW_IF(geo_label.empty(), std::logic_error,
-                "Module '" << get_name() << "' has no valid '" << "Geo_label" << "' property !");
-    DT_THROW_IF(! service_manager_.has(geo_label) ||
-                ! service_manager_.is_a<geomtools::geometry_service>(geo_label),
-                std::logic_error,
-                "Module '" << get_name() << "' has no '" << geo_label << "' service !");
-    const geomtools::geometry_service & Geo
-      = service_manager_.get<geomtools::geometry_service>(geo_label);
-
-    // Get geometry locator plugin
-    const geomtools::manager & geo_mgr = Geo.get_geom_manager();
-    std::string locator_plugin_name;
-    if (config_.has_key("locator_plugin_name")) {
-      locator_plugin_name = config_.fetch_string("locator_plugin_name");
+
+    // Calorimeter block positions are computed once for all or loaded from a
+    // cache file matching the geometry setup: in the latter case, the geometry
+    // service is not used at all
+    std::string cache_filename;
+    if (config_.has_key("geometry_cache.file")) {
+      cache_filename = config_.fetch_string("geometry_cache.file");
+      datatools::fetch_path_with_env(cache_filename);
+    }
+    std::string setup_label;
+    if (config_.has_key("geometry_cache.setup_label")) {
+      setup_label = config_.fetch_string("geometry_cache.setup_label");
+    }
+    std::string setup_version;
+    if (config_.has_key("geometry_cache.setup_version")) {
+      setup_version = config_.fetch_string("geometry_cache.setup_version");
+    }
+    const bool has_setup = ! setup_label.empty() && ! setup_version.empty();
+    if (! cache_filename.empty() && has_setup &&
+        _calo_blocks_.load(cache_filename, setup_label, setup_version, get_logging_priority())) {
+      DT_LOG_DEBUG(get_logging_priority(), "Calorimeter blocks loaded from '" << cache_filename << "'");
     } else {
-      // If no locator plugin name is set, then search for the first one
-      const geomtools::manager::plugins_dict_type & plugins = geo_mgr.get_plugins();
-      for (geomtools::manager::plugins_dict_type::const_iterator ip = plugins.begin();
-           ip != plugins.end();
-           ip++) {
-        const std::string & plugin_name = ip->first;
-        if (geo_mgr.is_plugin_a<snemo::geometry::locator_plugin>(plugin_name)) {
-          DT_LOG_DEBUG(get_logging_priority(), "Find locator plugin with name = " << plugin_name);
-          locator_plugin_name = plugin_name;
-          break;
+      // Geometry manager :
+      std::string geo_label = snemo::processing::service_info::default_geometry_service_label();
+      if (config_.has_key("Geo_label")) {
+        geo_label = config_.fetch_string("Geo_label");
+      }
+      DT_THROW_IF(geo_label.empty(), std::logic_error,
+                  "Module '" << get_name() << "' has no valid '" << "Geo_label" << "' property !");
+      DT_THROW_IF(! service_manager_.has(geo_label) ||
+                  ! service_manager_.is_a<geomtools::geometry_service>(geo_label),
+                  std::logic_error,
+                  "Module '" << get_name() << "' has no '" << geo_label << "' service !");
+      const geomtools::geometry_service & Geo
+        = service_manager_.get<geomtools::geometry_service>(geo_label);
+
+      // Get geometry locator plugin
+      const geomtools::manager & geo_mgr = Geo.get_geom_manager();
+      std::string locator_plugin_name;
+      if (config_.has_key("locator_plugin_name")) {
+        locator_plugin_name = config_.fetch_string("locator_plugin_name");
+      } else {
+        // If no locator plugin name is set, then search for the first one
+        const geomtools::manager::plugins_dict_type & plugins = geo_mgr.get_plugins();
+        for (geomtools::manager::plugins_dict_type::const_iterator ip = plugins.begin();
+             ip != plugins.end();
+             ip++) {
+          const std::string & plugin_name = ip->first;
+          if (geo_mgr.is_plugin_a<snemo::geometry::locator_plugin>(plugin_name)) {
+            DT_LOG_DEBUG(get_logging_priority(), "Find locator plugin with name = " << plugin_name);
+            locator_plugin_name = plugin_name;
+            break;
+          }
         }
       }
+      // Access to a given plugin by name and type :
+      DT_THROW_IF(! geo_mgr.has_plugin(locator_plugin_name) ||
+                  ! geo_mgr.is_plugin_a<snemo::geometry::locator_plugin>(locator_plugin_name),
+                  std::logic_error,
+                  "Found no locator plugin named '" << locator_plugin_name << "'");
+      _locator_plugin_ = &geo_mgr.get_plugin<snemo::geometry::locator_plugin>(locator_plugin_name);
+
+      const std::string & geo_setup_label   = geo_mgr.get_setup_label();
+      const std::string & geo_setup_version = geo_mgr.get_setup_version();
+      DT_THROW_IF(has_setup && (setup_label != geo_setup_label || setup_version != geo_setup_version),
+                  std::logic_error,
+                  "Module '" << get_name() << "' expects geometry setup '" << setup_label << "' ("
+                  << setup_version << ") but geometry service provides '" << geo_setup_label
+                  << "' (" << geo_setup_version << ") !");
+      _calo_blocks_.build(geo_mgr, *_locator_plugin_);
+      // The cache is only written once the geometry has been checked against
+      // the expected setup, so that it is never stored under a wrong key
+      if (! cache_filename.empty() && has_setup) {
+        _calo_blocks_.store(cache_filename, geo_setup_label, geo_setup_version);
+      }
     }
-    // Access to a given plugin by name and type :
-    DT_THROW_IF(! geo_mgr.has_plugin(locator_plugin_name) ||
-                ! geo_mgr.is_plugin_a<snemo::geometry::locator_plugin>(locator_plugin_name),
-                std::logic_error,
-                "Found no locator plugin named '" << locator_plugin_name << "'");
-    _locator_plugin_ = &geo_mgr.get_plugin<snemo::geometry::locator_plugin>(locator_plugin_name);
+    DT_LOG_DEBUG(get_logging_priority(), "Number of calorimeter blocks = " << _calo_blocks_.size());
 
     // Tag the module as initialized :
     _set_initialized (true);
@@ -173,6 +255,14 @@ namespace analysis {
                 std::logic_error,
                 "Module '" << get_name() << "' is not initialized !");
 
+    // Write the remaining events of the ntuple: a write failure must not
+    // prevent the module from being reset
+    try {
+      _ntuple_.close();
+    } catch (std::exception & error_) {
+      DT_LOG_ERROR(get_logging_priority(), "Closing the ntuple fails: " << error_.what());
+    }
+
     _set_defaults();
 
     // Tag the module as un-initialized :
@@ -202,23 +292,26 @@ namespace analysis {
       ptd.tree_dump();
     }
 
+    _event_.clear();
     this->_compute_energy_distribution(ptd);
     this->_compute_angular_distribution(ptd);
+    if (_ntuple_.is_open()) {
+      _ntuple_.fill(_event_);
+    }
 
     DT_LOG_TRACE(get_logging_priority(), "Exiting.");
     return dpp::base_module::PROCESS_SUCCESS;
   }
 
-  void snemo_bremsstrahlung_module::_compute_energy_distribution(const snemo::datamodel::particle_track_data & ptd_) const
+  void snemo_bremsstrahlung_module::_compute_energy_distribution(const snemo::datamodel::particle_track_data & ptd_)
   {
+    const bool store_event = _ntuple_.is_open();
+
     // Loop over all saved particles
     const snemo::datamodel::particle_track_data::particle_collection_type & the_particles
       = ptd_.get_particles();
-    for (snemo::datamodel::particle_track_data::particle_collection_type::const_iterator
-           iparticle = the_particles.begin();
-         iparticle != the_particles.end();
-         ++iparticle) {
-      const snemo::datamodel::particle_track & a_particle = iparticle->get();
+    for (size_t iparticle = 0; iparticle < the_particles.size(); iparticle++) {
+      const snemo::datamodel::particle_track & a_particle = the_particles[iparticle].get();
 
         if (!a_particle.has_associated_calorimeter_hits()) continue;
 
@@ -227,10 +320,16 @@ namespace analysis {
 
         if (the_calorimeters.size() > 1) continue;
 
+        const double electron_energy = the_calorimeters.front().get().get_energy();
+        if (store_event) {
+          _event_.electron_energies.push_back(electron_energy);
+          _event_.electron_particles.push_back(iparticle);
+        }
+
         // Filling the histograms :
         if (_histogram_pool_->has_1d("electron_energy")) {
           mygsl::histogram_1d & h1d = _histogram_pool_->grab_1d("electron_energy");
-          h1d.fill(the_calorimeters.front().get().get_energy());
+          h1d.fill(electron_energy);
         }
     }
 
@@ -241,7 +340,9 @@ namespace analysis {
     for (snemo::datamodel::calibrated_calorimeter_hit::collection_type::const_iterator
            icalo = the_non_asso_calos.begin();
          icalo != the_non_asso_calos.end(); ++icalo) {
-      total_gamma_energy += icalo->get().get_energy();
+      const double gamma_energy = icalo->get().get_energy();
+      if (store_event) _event_.gamma_energies.push_back(gamma_energy);
+      total_gamma_energy += gamma_energy;
     }
     // Filling the histograms :
     if (_histogram_pool_->has_1d("gamma_energy")) {
@@ -252,82 +353,103 @@ namespace analysis {
     return;
   }
 
-  void snemo_bremsstrahlung_module::_compute_angular_distribution(const snemo::datamodel::particle_track_data & ptd_) const
+  void snemo_bremsstrahlung_module::_compute_angular_distribution(const snemo::datamodel::particle_track_data & ptd_)
   {
+    const bool store_event = _ntuple_.is_open();
+    mygsl::histogram_1d * h1d = 0;
+    if (_histogram_pool_->has_1d("gamma_angle")) {
+      h1d = &_histogram_pool_->grab_1d("gamma_angle");
+    }
+
+    // Gather the positions of all non associated calorimeters
+    const snemo::datamodel::calibrated_calorimeter_hit::collection_type & the_non_asso_calos
+      = ptd_.get_non_associated_calorimeters();
+    const size_t ncalos = the_non_asso_calos.size();
+    _gamma_x_.resize(ncalos);
+    _gamma_y_.resize(ncalos);
+    _gamma_z_.resize(ncalos);
+    _gamma_angles_.resize(ncalos);
+    for (size_t i = 0; i < ncalos; i++) {
+      // Get block geom_id
+      const geomtools::geom_id & a_gid = the_non_asso_calos[i].get().get_geom_id();
+      const geomtools::vector_3d * vblock = _calo_blocks_.get_position(a_gid);
+      DT_THROW_IF(vblock == 0, std::logic_error,
+                  "The calorimeter with geom_id '" << a_gid << "' has not be found !");
+      _gamma_x_[i] = vblock->x();
+      _gamma_y_[i] = vblock->y();
+      _gamma_z_[i] = vblock->z();
+    }
     // Loop over all saved particles
     const snemo::datamodel::particle_track_data::particle_collection_type & the_particles
       = ptd_.get_particles();
-    for (snemo::datamodel::particle_track_data::particle_collection_type::const_iterator
-           iparticle = the_particles.begin();
-         iparticle != the_particles.end();
-         ++iparticle) {
-      const snemo::datamodel::particle_track & a_particle = iparticle->get();
+    for (size_t iparticle = 0; iparticle < the_particles.size(); iparticle++) {
+      const snemo::datamodel::particle_track & a_particle = the_particles[iparticle].get();
+
+      // Count vertices on source foil and keep the first one
+      size_t nvtx = 0;
+      const geomtools::vector_3d * first_vertex = 0;
+      if (a_particle.has_vertices()) {
+        const snemo::datamodel::particle_track::vertex_collection_type & the_vertices
+          = a_particle.get_vertices();
+        for (snemo::datamodel::particle_track::vertex_collection_type::const_iterator
+               ivertex = the_vertices.begin();
+             ivertex != the_vertices.end(); ++ivertex) {
+          const geomtools::blur_spot & a_vertex = ivertex->get();
+          if (! snemo::datamodel::particle_track::vertex_is_on_source_foil(a_vertex)) continue;
+          if (nvtx++ == 0) first_vertex = &a_vertex.get_position();
+          if (store_event) {
+            _event_.vertices.push_back(a_vertex.get_position());
+            _event_.vertex_particles.push_back(iparticle);
+          }
+        }
+      }
+
+      if (ncalos == 0) continue;
 
       if (! a_particle.has_trajectory()) {
         DT_LOG_DEBUG(get_logging_priority(), "Current particle has no trajectory !");
         continue;
       }
 
-      // Retrieve a subset of vertices
-      snemo::datamodel::particle_track::vertex_collection_type vertices;
-      const size_t nvtx = a_particle.fetch_vertices(vertices, snemo::datamodel::particle_track::VERTEX_ON_SOURCE_FOIL);
-      if (nvtx != 1) {
-        DT_LOG_DEBUG(get_logging_priority(), "Current particle has more than one vertex on source foil !");
+      // Angles of particles with several foil vertices are only stored so the
+      // vertex selection can be changed when reading the ntuple back
+      if (nvtx == 0 || (nvtx > 1 && ! store_event)) {
+        DT_LOG_DEBUG(get_logging_priority(), "Current particle has no single vertex on source foil !");
         continue;
       }
 
       // Get helix parameters
       const snemo::datamodel::tracker_trajectory & a_trajectory = a_particle.get_trajectory();
       const snemo::datamodel::base_trajectory_pattern & a_track_pattern = a_trajectory.get_pattern();
-      DT_THROW_IF(a_track_pattern.get_pattern_id() != snemo::datamodel::helix_trajectory_pattern::pattern_id(),
-                  std::logic_error, "Trajectory must be an helix !");
+      if (a_track_pattern.get_pattern_id() != snemo::datamodel::helix_trajectory_pattern::pattern_id()) {
+        DT_THROW_IF(nvtx == 1, std::logic_error, "Trajectory must be an helix !");
+        continue;
+      }
 
       const snemo::datamodel::helix_trajectory_pattern * ptr_helix
         = dynamic_cast<const snemo::datamodel::helix_trajectory_pattern *>(&a_track_pattern);
       const geomtools::helix_3d & a_helix = ptr_helix->get_helix();
       const geomtools::vector_3d & vcenter = a_helix.get_center();
-      const geomtools::vector_3d & vfoil = vertices.front().get().get_position();
+      const geomtools::vector_3d & vfoil = *first_vertex;
       // Compute orthogonal vector
       const geomtools::vector_3d vorth = (vfoil - vcenter).orthogonal();
 
       DT_LOG_DEBUG(get_logging_priority(), "Particle direction = " << vorth);
 
-      // Loop over all non associated calorimeters to compute angle difference
-      const snemo::datamodel::calibrated_calorimeter_hit::collection_type & the_non_asso_calos
-        = ptd_.get_non_associated_calorimeters();
-      for (snemo::datamodel::calibrated_calorimeter_hit::collection_type::const_iterator
-             icalo = the_non_asso_calos.begin();
-           icalo != the_non_asso_calos.end(); ++icalo)
-        {
-          // Get block geom_id
-          const geomtools::geom_id & a_gid = icalo->get().get_geom_id();
-
-          // Get block position given
-          geomtools::vector_3d vblock;
-          geomtools::invalidate(vblock);
-
-          const snemo::geometry::calo_locator & calo_locator = _locator_plugin_->get_calo_locator();
-          const snemo::geometry::xcalo_locator & xcalo_locator = _locator_plugin_->get_xcalo_locator();
-          const snemo::geometry::gveto_locator & gveto_locator = _locator_plugin_->get_gveto_locator();
-          if (calo_locator.is_calo_block(a_gid)) {
-            calo_locator.get_block_position(a_gid, vblock);
-          } else if (xcalo_locator.is_calo_block(a_gid)) {
-            xcalo_locator.get_block_position(a_gid, vblock);
-          } else if (gveto_locator.is_calo_block(a_gid)) {
-            gveto_locator.get_block_position(a_gid, vblock);
-          }
-          DT_THROW_IF(! geomtools::is_valid(vblock), std::logic_error,
-                      "The calorimeter with geom_id '" << a_gid << "' has not be found !");
-
-          const double angle = vorth.angle(vblock - vfoil);
-          DT_LOG_DEBUG(get_logging_priority(), "The angle between electron and gamma is "
-                       << angle / CLHEP::degree << " degree");
-          // Filling the histograms :
-          if (_histogram_pool_->has_1d("gamma_angle")) {
-            mygsl::histogram_1d & h1d = _histogram_pool_->grab_1d("gamma_angle");
-            h1d.fill(angle);
-          }
+      // Compute angle difference with all non associated calorimeters at once
+      compute_angles(ncalos, &_gamma_x_[0], &_gamma_y_[0], &_gamma_z_[0], vfoil, vorth, &_gamma_angles_[0]);
+      for (size_t i = 0; i < ncalos; i++) {
+        const double angle = _gamma_angles_[i];
+        DT_LOG_DEBUG(get_logging_priority(), "The angle between electron and gamma is "
+                     << angle / CLHEP::degree << " degree");
+        if (store_event) {
+          _event_.gamma_angles.push_back(angle);
+          _event_.angle_particles.push_back(iparticle);
+          _event_.angle_gammas.push_back(i);
         }
+        // Filling the histograms :
+        if (h1d && nvtx == 1) h1d->fill(angle);
+      }
     }
 
     return;
@@ -32,9 +32,16 @@
 #ifndef ANALYSIS_SNEMO_BREMSSTRAHLUNG_MODULE_H
 #define ANALYSIS_SNEMO_BREMSSTRAHLUNG_MODULE_H 1
 
+// Standard library:
+#include <vector>
+
 // Data processing module abstract base class
 #include <dpp/base_module.h>
 
+// This project:
+#include <calorimeter_block_table.h>
+#include <bremsstrahlung_ntuple.h>
+
 namespace mygsl {
   class histogram_pool;
 }
@@ -89,10 +96,10 @@ namespace analysis {
     void _set_defaults();
 
     /// Compute energy distributions.
-    void _compute_energy_distribution(const snemo::datamodel::particle_track_data & ptd_) const;
+    void _compute_energy_distribution(const snemo::datamodel::particle_track_data & ptd_);
 
     /// Compute angular distribution.
-    void _compute_angular_distribution(const snemo::datamodel::particle_track_data & ptd_) const;
+    void _compute_angular_distribution(const snemo::datamodel::particle_track_data & ptd_);
 
   private:
 
@@ -102,6 +109,23 @@ namespace analysis {
     // Locator plugin
     const snemo::geometry::locator_plugin * _locator_plugin_;
 
+    // Calorimeter block positions
+    calorimeter_block_table _calo_blocks_;
+
+    // Positions of the non associated calorimeters of the current event
+    std::vector<double> _gamma_x_;
+    std::vector<double> _gamma_y_;
+    std::vector<double> _gamma_z_;
+
+    // Electron/gamma angles of the current particle
+    std::vector<double> _gamma_angles_;
+
+    // Per event ntuple
+    bremsstrahlung_ntuple _ntuple_;
+
+    // Observables of the current event
+    bremsstrahlung_ntuple::event_type _event_;
+
     // Macro to automate the registration of the module :
     DPP_MODULE_REGISTRATION_INTERFACE(snemo_bremsstrahlung_module);
   };
@@ -34,6 +34,23 @@ namespace analysis {
     return *_histogram_pool_;
   }
 
+  bool base_plotter::has_geometry_tools() const
+  {
+    return _geometry_tools_ != 0;
+  }
+
+  void base_plotter::set_geometry_tools(const snemo::utils::geometry_tools & tools_)
+  {
+    _geometry_tools_ = &tools_;
+    return;
+  }
+
+  const snemo::utils::geometry_tools & base_plotter::get_geometry_tools() const
+  {
+    DT_THROW_IF(! has_geometry_tools(), std::logic_error, "Missing geometry toolbox !");
+    return *_geometry_tools_;
+  }
+
   bool base_plotter::is_initialized() const
   {
     return _initialized;
@@ -109,6 +126,8 @@ namespace analysis {
   {
     _initialized = false;
     _logging = datatools::logger::PRIO_FATAL;
+    _histogram_pool_ = 0;
+    _geometry_tools_ = 0;
     set_logging_priority(p_);
     return;
   }
@@ -50,6 +50,12 @@ namespace mygsl {
   class histogram_pool;
 }
 
+namespace snemo {
+  namespace utils {
+    class geometry_tools;
+  }
+}
+
 namespace snemo {
 namespace analysis {
 
@@ -67,6 +73,15 @@ namespace analysis {
     /// Return a mutable reference to histogra pool
     mygsl::histogram_pool & grab_histogram_pool();
 
+    /// Check geometry toolbox existence
+    bool has_geometry_tools() const;
+
+    /// Set geometry toolbox pointer
+    void set_geometry_tools(const snemo::utils::geometry_tools & tools_);
+
+    /// Return a non-mutable reference to geometry toolbox
+    const snemo::utils::geometry_tools & get_geometry_tools() const;
+
     /// Default constructor
     base_plotter(datatools::logger::priority p_ = datatools::logger::PRIO_FATAL);
 
@@ -149,6 +164,7 @@ namespace analysis {
   private:
 
     mygsl::histogram_pool * _histogram_pool_;//!< Histogram pool
+    const snemo::utils::geometry_tools * _geometry_tools_; //!< Geometry toolbox
 
   };
 
@@ -7,17 +7,20 @@
 #include <stdexcept>
 #include <string>
 #include <sstream>
+#include <vector>
+#include <cmath>
 
 // Third party:
 // - Bayeux/datatools:
 #include <bayeux/datatools/properties.h>
 #include <bayeux/datatools/ioutils.h>
 #include <bayeux/datatools/object_configuration_description.h>
+#include <bayeux/datatools/utils.h>
+#include <bayeux/datatools/clhep_units.h>
 // - Bayeux/mygsl
 #include <bayeux/mygsl/histogram_pool.h>
 
 // - Falaise
-#include <falaise/snemo/geometry/gg_locator.h>
 #include <falaise/snemo/datamodels/data_model.h>
 #include <falaise/snemo/datamodels/calibrated_data.h>
 
@@ -51,6 +54,35 @@ namespace analysis {
   {
     ::snemo::analysis::base_plotter::_common_initialize(setup_);
 
+    // Heatmaps are accumulated by channel and filled at the end
+    mygsl::histogram_pool & a_pool = grab_histogram_pool();
+    if (a_pool.has_2d("CD::gg_heatmap") || a_pool.has_2d("CD::calo_heatmap")) {
+      _channel_counts_.assign(get_geometry_tools().get_number_of_channels(), 0);
+    }
+
+    // Calorimeter spectra are accumulated by block with the binning along the
+    // y axis of their histogram, the x axis being the block index
+    const size_t nblocks = get_geometry_tools().get_number_of_calo_blocks();
+    if (nblocks > 0 && a_pool.has_2d("CD::calo_channel_energy")) {
+      const mygsl::histogram_2d & h2d = a_pool.grab_2d("CD::calo_channel_energy");
+      _calo_energy_spectra_.initialize(nblocks, h2d.ybins(), h2d.ymin(), h2d.ymax());
+    }
+    if (nblocks > 0 && a_pool.has_2d("CD::calo_channel_time")) {
+      const mygsl::histogram_2d & h2d = a_pool.grab_2d("CD::calo_channel_time");
+      _calo_time_spectra_.initialize(nblocks, h2d.ybins(), h2d.ymin(), h2d.ymax());
+    }
+    if (setup_.has_key("export_channel_spectra")) {
+      _export_channel_spectra_ = setup_.fetch_boolean("export_channel_spectra");
+    }
+
+    // Drift radius and longitudinal position statistics by Geiger cell
+    if (setup_.has_key("cell_statistics") && setup_.fetch_boolean("cell_statistics")) {
+      _initialize_cell_statistics_(setup_, "drift_radius", 0.0, 25.0 * CLHEP::mm,
+                                   _drift_radius_stats_, _drift_radius_stats_file_);
+      _initialize_cell_statistics_(setup_, "long_position", -1.5 * CLHEP::m, +1.5 * CLHEP::m,
+                                   _long_position_stats_, _long_position_stats_file_);
+    }
+
     _set_initialized(true);
     return;
   }
@@ -60,6 +92,10 @@ namespace analysis {
   {
     DT_THROW_IF(! is_initialized(), std::logic_error,
                 "Plotter '" << get_name() << "' is not initialized !");
+    _fill_heatmaps_();
+    _export_calorimeter_spectra_();
+    _export_cell_statistics_("drift_radius", _drift_radius_stats_, _drift_radius_stats_file_);
+    _export_cell_statistics_("long_position", _long_position_stats_, _long_position_stats_file_);
     _set_initialized(false);
     _set_defaults();
     return;
@@ -84,6 +120,14 @@ namespace analysis {
   void calibrated_data_plotter::_set_defaults()
   {
     set_bank_label(snemo::datamodel::data_info::default_calibrated_data_label());
+    _channel_counts_.clear();
+    _calo_energy_spectra_.reset();
+    _calo_time_spectra_.reset();
+    _export_channel_spectra_ = false;
+    _drift_radius_stats_.reset();
+    _long_position_stats_.reset();
+    _drift_radius_stats_file_.clear();
+    _long_position_stats_file_.clear();
     return;
   }
 
@@ -110,6 +154,28 @@ namespace analysis {
       mygsl::histogram_1d & h1d = a_pool.grab_1d("CD::ncalohits");
       h1d.fill((int)calo_hits.size());
     }
+
+    // Energy sums by calorimeter wall (indexed by channel category)
+    double wall_energies[4] = { 0.0, 0.0, 0.0, 0.0 };
+    const snemo::utils::geometry_tools & a_tools = get_geometry_tools();
+    for (auto & calo_handle : calo_hits) {
+      if (! calo_handle.has_data()) continue;
+      auto & calo_hit = calo_handle.get();
+      const int a_index = a_tools.get_channel_index(calo_hit.get_geom_id());
+      if (a_index < 0) continue;
+      if (! _channel_counts_.empty()) _channel_counts_[a_index]++;
+      const snemo::utils::geometry_tools::channel_type & a_channel = a_tools.get_channel(a_index);
+      _calo_energy_spectra_.fill(a_channel.id, calo_hit.get_energy());
+      _calo_time_spectra_.fill(a_channel.id, calo_hit.get_time());
+      wall_energies[a_channel.category] += calo_hit.get_energy();
+    }
+    const char * wall_names[4] = { 0, "CD::main_wall_energy", "CD::xwall_energy", "CD::gveto_energy" };
+    for (size_t i = snemo::utils::geometry_tools::CALO_CHANNEL; i < 4; i++) {
+      if (wall_energies[i] > 0.0 && a_pool.has_1d(wall_names[i])) {
+        mygsl::histogram_1d & h1d = a_pool.grab_1d(wall_names[i]);
+        h1d.fill(wall_energies[i]);
+      }
+    }
     return;
   }
 
@@ -142,26 +208,183 @@ namespace analysis {
         mygsl::histogram_1d & h1d = a_pool.grab_1d("CD::long_position_error");
         h1d.fill(gg_hit.get_sigma_z());
       }
-      if (a_pool.has_2d("CD::gg_heatmap")) {
-        const geomtools::geom_id & a_gid = gg_hit.get_geom_id();
-        const snemo::geometry::gg_locator & a_gg_locator
-          = snemo::utils::geometry_tools::get_instance().get_gg_locator();
-        const int a_sign = (a_gg_locator.extract_side(a_gid)
-                            == snemo::geometry::utils::SIDE_BACK ? 1 : -1);
-        const int a_row = a_gg_locator.extract_row(a_gid);
-        const int a_layer = a_sign * (a_gg_locator.extract_layer(a_gid) + 1);
-        mygsl::histogram_2d & h2d = a_pool.grab_2d("CD::gg_heatmap");
-        h2d.fill(a_layer, a_row);
+      if (_channel_counts_.empty() && ! _drift_radius_stats_.is_initialized()) continue;
+      const int a_index = get_geometry_tools().get_channel_index(gg_hit.get_geom_id());
+      if (a_index < 0) continue;
+      if (! _channel_counts_.empty()) _channel_counts_[a_index]++;
+      if (_drift_radius_stats_.is_initialized()) {
+        const size_t a_cell = get_geometry_tools().get_channel(a_index).id;
+        _drift_radius_stats_.fill(a_cell, gg_hit.get_r());
+        _long_position_stats_.fill(a_cell, gg_hit.get_z());
       }
     }
     return;
   }
 
+  void calibrated_data_plotter::_fill_heatmaps_()
+  {
+    if (_channel_counts_.empty()) return;
+    mygsl::histogram_pool & a_pool = grab_histogram_pool();
+    mygsl::histogram_2d * heatmaps[4] = { 0, 0, 0, 0 };
+    if (a_pool.has_2d("CD::gg_heatmap")) {
+      heatmaps[snemo::utils::geometry_tools::GG_CHANNEL] = &a_pool.grab_2d("CD::gg_heatmap");
+    }
+    if (a_pool.has_2d("CD::calo_heatmap")) {
+      heatmaps[snemo::utils::geometry_tools::CALO_CHANNEL] = &a_pool.grab_2d("CD::calo_heatmap");
+    }
+    for (size_t i = 0; i < _channel_counts_.size(); i++) {
+      if (_channel_counts_[i] == 0) continue;
+      const snemo::utils::geometry_tools::channel_type & a_channel
+        = get_geometry_tools().get_channel(i);
+      mygsl::histogram_2d * h2d = heatmaps[a_channel.category];
+      if (h2d) h2d->fill(a_channel.x, a_channel.y, _channel_counts_[i]);
+    }
+    _channel_counts_.assign(_channel_counts_.size(), 0);
+    return;
+  }
+
+  void calibrated_data_plotter::_export_calorimeter_spectra_()
+  {
+    mygsl::histogram_pool & a_pool = grab_histogram_pool();
+    const std::string names[2] = { "CD::calo_channel_energy", "CD::calo_channel_time" };
+    const channel_spectra * spectra[2] = { &_calo_energy_spectra_, &_calo_time_spectra_ };
+    for (size_t i = 0; i < 2; i++) {
+      const channel_spectra & a_spectra = *spectra[i];
+      if (! a_spectra.is_initialized()) continue;
+      mygsl::histogram_2d & h2d = a_pool.grab_2d(names[i]);
+      for (size_t ichannel = 0; ichannel < a_spectra.get_number_of_channels(); ichannel++) {
+        mygsl::histogram_1d * h1d = 0;
+        if (_export_channel_spectra_) {
+          // Block histograms are named after the block geom_id (type:address)
+          const geomtools::geom_id & a_gid = get_geometry_tools().get_calo_block(ichannel).gid;
+          std::ostringstream a_name;
+          a_name << names[i] << "::" << a_gid.get_type() << ':';
+          for (size_t j = 0; j < a_gid.get_depth(); j++) {
+            if (a_gid.is_any(j)) continue;
+            if (j > 0) a_name << '.';
+            a_name << a_gid.get(j);
+          }
+          if (a_pool.has_1d(a_name.str())) {
+            h1d = &a_pool.grab_1d(a_name.str());
+          } else {
+            h1d = &a_pool.add_1d(a_name.str(), "", "CD/channels");
+            h1d->initialize(a_spectra.get_number_of_bins(), a_spectra.get_min(), a_spectra.get_max());
+          }
+        }
+        for (size_t ibin = 0; ibin < a_spectra.get_number_of_bins(); ibin++) {
+          const uint32_t a_count = a_spectra.get_count(ichannel, ibin);
+          if (a_count == 0) continue;
+          const double a_value = a_spectra.get_bin_center(ibin);
+          h2d.fill(ichannel, a_value, a_count);
+          if (h1d) h1d->fill(a_value, a_count);
+        }
+      }
+    }
+    _calo_energy_spectra_.clear();
+    _calo_time_spectra_.clear();
+    return;
+  }
+
+  void calibrated_data_plotter::_initialize_cell_statistics_(const datatools::properties & setup_,
+                                                             const std::string & quantity_,
+                                                             double min_, double max_,
+                                                             cell_statistics & stats_,
+                                                             std::string & filename_)
+  {
+    const std::string prefix = "cell_statistics." + quantity_ + ".";
+
+    // Range of the coarse histograms
+    if (setup_.has_key(prefix + "min")) {
+      min_ = setup_.fetch_real(prefix + "min");
+      if (! setup_.has_explicit_unit(prefix + "min")) min_ *= CLHEP::mm;
+    }
+    if (setup_.has_key(prefix + "max")) {
+      max_ = setup_.fetch_real(prefix + "max");
+      if (! setup_.has_explicit_unit(prefix + "max")) max_ *= CLHEP::mm;
+    }
+    stats_.initialize(get_geometry_tools().get_number_of_gg_cells(), min_, max_);
+
+    // Statistics from previous jobs
+    if (setup_.has_key(prefix + "input_files")) {
+      std::vector<std::string> input_files;
+      setup_.fetch(prefix + "input_files", input_files);
+      for (size_t i = 0; i < input_files.size(); i++) {
+        datatools::fetch_path_with_env(input_files[i]);
+        stats_.load(input_files[i]);
+      }
+    }
+    if (setup_.has_key(prefix + "output_file")) {
+      filename_ = setup_.fetch_string(prefix + "output_file");
+      datatools::fetch_path_with_env(filename_);
+    }
+    return;
+  }
+
+  void calibrated_data_plotter::_export_cell_statistics_(const std::string & quantity_,
+                                                         const cell_statistics & stats_,
+                                                         const std::string & filename_)
+  {
+    if (! stats_.is_initialized()) return;
+
+    // Cell maps use the same coordinates as the Geiger heatmap
+    mygsl::histogram_pool & a_pool = grab_histogram_pool();
+    const std::string mean_name  = "CD::gg_" + quantity_ + "_mean";
+    const std::string sigma_name = "CD::gg_" + quantity_ + "_sigma";
+    mygsl::histogram_2d * h_mean  = a_pool.has_2d(mean_name)  ? &a_pool.grab_2d(mean_name)  : 0;
+    mygsl::histogram_2d * h_sigma = a_pool.has_2d(sigma_name) ? &a_pool.grab_2d(sigma_name) : 0;
+    const snemo::utils::geometry_tools & a_tools = get_geometry_tools();
+    for (size_t i = 0; i < a_tools.get_number_of_channels(); i++) {
+      const snemo::utils::geometry_tools::channel_type & a_channel = a_tools.get_channel(i);
+      if (a_channel.category != snemo::utils::geometry_tools::GG_CHANNEL) continue;
+      const cell_statistics::accumulator_type & a_cell = stats_.get(a_channel.id);
+      if (a_cell.count == 0) continue;
+      if (h_mean)  h_mean->fill(a_channel.x, a_channel.y, a_cell.mean);
+      if (h_sigma) h_sigma->fill(a_channel.x, a_channel.y, std::sqrt(a_cell.get_variance()));
+    }
+    if (! filename_.empty()) stats_.store(filename_);
+    return;
+  }
+
   void calibrated_data_plotter::init_ocd(datatools::object_configuration_description & ocd_)
   {
     // Invoke OCD support from parent class :
     ::snemo::analysis::base_plotter::common_ocd(ocd_);
 
+    {
+      datatools::configuration_property_description & cpd = ocd_.add_property_info();
+      cpd.set_name_pattern("export_channel_spectra")
+        .set_from("analysis::calibrated_data_plotter")
+        .set_terse_description("Flag to export calorimeter spectra block by block")
+        .set_traits(datatools::TYPE_BOOLEAN)
+        .set_mandatory(false)
+        .set_long_description("Beside the 'CD::calo_channel_energy' and 'CD::calo_channel_time'\n"
+                              "histograms, add one histogram by calorimeter block to the pool.")
+        .add_example("Example::                                 \n"
+                     "                                          \n"
+                     "  export_channel_spectra : boolean = true \n"
+                     "                                          \n"
+                     )
+        ;
+    }
+
+    {
+      datatools::configuration_property_description & cpd = ocd_.add_property_info();
+      cpd.set_name_pattern("cell_statistics")
+        .set_from("analysis::calibrated_data_plotter")
+        .set_terse_description("Flag to accumulate statistics by Geiger cell")
+        .set_traits(datatools::TYPE_BOOLEAN)
+        .set_mandatory(false)
+        .set_long_description("Accumulate the number of entries, mean, variance and a coarse\n"
+                              "histogram of drift radius and longitudinal position by Geiger\n"
+                              "cell. Range and files are set by 'cell_statistics.drift_radius.*'\n"
+                              "and 'cell_statistics.long_position.*' properties.")
+        .add_example("Example::                          \n"
+                     "                                   \n"
+                     "  cell_statistics : boolean = true \n"
+                     "                                   \n"
+                     )
+        ;
+    }
     return;
   }
 
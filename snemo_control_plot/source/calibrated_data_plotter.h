@@ -31,8 +31,14 @@
 #ifndef SNEMO_ANALYSIS_CALIBRATED_DATA_PLOTTER_H
 #define SNEMO_ANALYSIS_CALIBRATED_DATA_PLOTTER_H 1
 
+// Standard library:
+#include <vector>
+#include <stdint.h>
+
 // This project:
 #include <base_plotter.h>
+#include <channel_spectra.h>
+#include <cell_statistics.h>
 
 namespace snemo {
 // Forward declaration:
@@ -83,6 +89,35 @@ namespace analysis {
     /// Dedicated plotter for calibrated tracker hits
     void _plot_tracker_hits_(const snemo::datamodel::calibrated_data & cd_);
 
+    /// Fill the heatmap histograms with channel counts
+    void _fill_heatmaps_();
+
+    /// Fill the per channel calorimeter histograms with the spectra counts
+    void _export_calorimeter_spectra_();
+
+    /// Initialize the statistics by Geiger cell of a quantity
+    void _initialize_cell_statistics_(const datatools::properties & setup_,
+                                      const std::string & quantity_,
+                                      double min_, double max_,
+                                      cell_statistics & stats_,
+                                      std::string & filename_);
+
+    /// Fill the cell maps and save the statistics by Geiger cell of a quantity
+    void _export_cell_statistics_(const std::string & quantity_,
+                                  const cell_statistics & stats_,
+                                  const std::string & filename_);
+
+  private:
+
+    std::vector<uint32_t> _channel_counts_;       //!< Number of hits by channel index
+    channel_spectra       _calo_energy_spectra_;  //!< Energy spectra by calorimeter block
+    channel_spectra       _calo_time_spectra_;    //!< Time distributions by calorimeter block
+    bool                  _export_channel_spectra_; //!< Flag to export one histogram by block
+    cell_statistics       _drift_radius_stats_;   //!< Drift radius statistics by Geiger cell
+    cell_statistics       _long_position_stats_;  //!< Longitudinal position statistics by Geiger cell
+    std::string           _drift_radius_stats_file_;  //!< Output file of drift radius statistics
+    std::string           _long_position_stats_file_; //!< Output file of longitudinal position statistics
+
   };
 
 } // end of namespace analysis
@@ -0,0 +1,179 @@
+/// cell_statistics.cc
+
+// Ourselves:
+#include <cell_statistics.h>
+
+// Standard library:
+#include <stdexcept>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+
+// Third party:
+// - Bayeux/datatools:
+#include <bayeux/datatools/exception.h>
+
+namespace snemo {
+namespace analysis {
+
+  namespace {
+    const std::string HEADER = "#@cell_statistics";
+  }
+
+  const size_t cell_statistics::NBINS;
+
+  cell_statistics::accumulator_type::accumulator_type()
+    : count(0), mean(0.0), m2(0.0)
+  {
+    for (size_t i = 0; i < NBINS; i++) bins[i] = 0;
+    return;
+  }
+
+  double cell_statistics::accumulator_type::get_variance() const
+  {
+    return count > 1 ? m2 / (count - 1) : 0.0;
+  }
+
+  cell_statistics::cell_statistics()
+  {
+    reset();
+    return;
+  }
+
+  bool cell_statistics::is_initialized() const
+  {
+    return ! _cells_.empty();
+  }
+
+  void cell_statistics::initialize(size_t ncells_, double min_, double max_)
+  {
+    DT_THROW_IF(ncells_ == 0, std::logic_error, "Invalid number of cells !");
+    DT_THROW_IF(! (min_ < max_), std::logic_error, "Invalid histogram range !");
+    _min_       = min_;
+    _max_       = max_;
+    _inv_width_ = NBINS / (max_ - min_);
+    _cells_.assign(ncells_, accumulator_type());
+    return;
+  }
+
+  void cell_statistics::reset()
+  {
+    _min_       = 0.0;
+    _max_       = 0.0;
+    _inv_width_ = 0.0;
+    _cells_.clear();
+    return;
+  }
+
+  void cell_statistics::fill(size_t cell_, double value_)
+  {
+    if (cell_ >= _cells_.size() || value_ != value_) return;
+    accumulator_type & a_cell = _cells_[cell_];
+    // Welford update of the mean and of the sum of squared deviations
+    a_cell.count++;
+    const double delta = value_ - a_cell.mean;
+    a_cell.mean += delta / a_cell.count;
+    a_cell.m2   += delta * (value_ - a_cell.mean);
+    const double u = (value_ - _min_) * _inv_width_;
+    const size_t a_bin = u < 0.0 ? 0 : (u >= NBINS ? NBINS - 1 : static_cast<size_t>(u));
+    a_cell.bins[a_bin]++;
+    return;
+  }
+
+  void cell_statistics::merge(const cell_statistics & other_)
+  {
+    DT_THROW_IF(other_._cells_.size() != _cells_.size() ||
+                other_._min_ != _min_ || other_._max_ != _max_,
+                std::logic_error, "Cell statistics have different layouts !");
+    for (size_t i = 0; i < _cells_.size(); i++) {
+      accumulator_type & a_cell = _cells_[i];
+      const accumulator_type & other_cell = other_._cells_[i];
+      if (other_cell.count == 0) continue;
+      // Pairwise combination of means and squared deviations
+      const double na = a_cell.count;
+      const double nb = other_cell.count;
+      const double delta = other_cell.mean - a_cell.mean;
+      a_cell.count += other_cell.count;
+      a_cell.mean  += delta * nb / (na + nb);
+      a_cell.m2    += other_cell.m2 + delta * delta * na * nb / (na + nb);
+      for (size_t j = 0; j < NBINS; j++) a_cell.bins[j] += other_cell.bins[j];
+    }
+    return;
+  }
+
+  size_t cell_statistics::get_number_of_cells() const
+  {
+    return _cells_.size();
+  }
+
+  double cell_statistics::get_min() const
+  {
+    return _min_;
+  }
+
+  double cell_statistics::get_max() const
+  {
+    return _max_;
+  }
+
+  const cell_statistics::accumulator_type & cell_statistics::get(size_t cell_) const
+  {
+    DT_THROW_IF(cell_ >= _cells_.size(), std::range_error, "Invalid cell index " << cell_ << " !");
+    return _cells_[cell_];
+  }
+
+  void cell_statistics::store(const std::string & filename_) const
+  {
+    std::ofstream fout(filename_.c_str());
+    DT_THROW_IF(! fout, std::runtime_error, "Cannot open file '" << filename_ << "' !");
+    fout << std::setprecision(std::numeric_limits<double>::digits10 + 2);
+    fout << HEADER << ' ' << _cells_.size() << ' ' << NBINS << ' '
+         << _min_ << ' ' << _max_ << std::endl;
+    for (size_t i = 0; i < _cells_.size(); i++) {
+      const accumulator_type & a_cell = _cells_[i];
+      fout << a_cell.count << ' ' << a_cell.mean << ' ' << a_cell.m2;
+      for (size_t j = 0; j < NBINS; j++) fout << ' ' << a_cell.bins[j];
+      fout << std::endl;
+    }
+    DT_THROW_IF(! fout, std::runtime_error, "Writing into file '" << filename_ << "' fails !");
+    return;
+  }
+
+  void cell_statistics::load(const std::string & filename_)
+  {
+    std::ifstream fin(filename_.c_str());
+    DT_THROW_IF(! fin, std::runtime_error, "Cannot open file '" << filename_ << "' !");
+    std::string header;
+    size_t ncells = 0;
+    size_t nbins = 0;
+    double min = 0.0;
+    double max = 0.0;
+    fin >> header >> ncells >> nbins >> min >> max;
+    DT_THROW_IF(! fin || header != HEADER, std::runtime_error,
+                "File '" << filename_ << "' is not a cell statistics record !");
+    DT_THROW_IF(nbins != NBINS, std::logic_error,
+                "Record stored in '" << filename_ << "' has a different number of bins !");
+    cell_statistics other;
+    other.initialize(ncells, min, max);
+    for (size_t i = 0; i < ncells; i++) {
+      accumulator_type & a_cell = other._cells_[i];
+      fin >> a_cell.count >> a_cell.mean >> a_cell.m2;
+      for (size_t j = 0; j < NBINS; j++) fin >> a_cell.bins[j];
+    }
+    DT_THROW_IF(! fin, std::runtime_error, "File '" << filename_ << "' is truncated !");
+    if (! is_initialized()) initialize(ncells, min, max);
+    merge(other);
+    return;
+  }
+
+} // end of namespace analysis
+} // end of namespace snemo
+
+// end of cell_statistics.cc
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
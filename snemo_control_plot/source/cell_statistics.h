@@ -0,0 +1,125 @@
+/// \file cell_statistics.h
+/* Author(s)     : Xavier Garrido <garrido@lal.in2p3.fr>
+ * Creation date : 2026-10-18
+ * Last modified : 2026-10-18
+ *
+ * Copyright (C) 2026 Xavier Garrido <garrido@lal.in2p3.fr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * Description:
+ *
+ *   Streaming statistics of a quantity by Geiger cell: number of entries,
+ *   mean, variance and a coarse histogram. Statistics filled in different
+ *   threads or jobs can be merged exactly, and saved into a file to be merged
+ *   later.
+ *
+ * History:
+ *
+ */
+
+#ifndef SNEMO_ANALYSIS_CELL_STATISTICS_H
+#define SNEMO_ANALYSIS_CELL_STATISTICS_H 1
+
+// Standard library:
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace snemo {
+namespace analysis {
+
+  /// \brief Streaming statistics by cell
+  class cell_statistics
+  {
+  public:
+
+    /// Number of bins of the coarse histogram
+    static const size_t NBINS = 16;
+
+    /// \brief Statistics of one cell
+    struct accumulator_type
+    {
+      /// Default constructor
+      accumulator_type();
+
+      /// Return the unbiased variance
+      double get_variance() const;
+
+      uint32_t count;        //!< Number of entries
+      double   mean;         //!< Running mean
+      double   m2;           //!< Sum of squared deviations to the mean
+      uint32_t bins[NBINS];  //!< Coarse histogram, out of range values in edge bins
+    };
+
+    /// Default constructor
+    cell_statistics();
+
+    /// Check if the accumulators are allocated
+    bool is_initialized() const;
+
+    /// Allocate the accumulators with the range of the coarse histograms
+    void initialize(size_t ncells_, double min_, double max_);
+
+    /// Release the accumulators
+    void reset();
+
+    /// Add a value to a cell
+    void fill(size_t cell_, double value_);
+
+    /// Add the statistics of another record with the same layout
+    void merge(const cell_statistics & other_);
+
+    /// Return the number of cells
+    size_t get_number_of_cells() const;
+
+    /// Return the lower bound of the coarse histograms
+    double get_min() const;
+
+    /// Return the upper bound of the coarse histograms
+    double get_max() const;
+
+    /// Return the statistics of a cell
+    const accumulator_type & get(size_t cell_) const;
+
+    /// Save the statistics into a file
+    void store(const std::string & filename_) const;
+
+    /// Add the content of a file to the statistics
+    void load(const std::string & filename_);
+
+  private:
+
+    double _min_;       //!< Lower bound of the coarse histograms
+    double _max_;       //!< Upper bound of the coarse histograms
+    double _inv_width_; //!< Inverse of the coarse bin width
+    std::vector<accumulator_type> _cells_; //!< Statistics by cell
+
+  };
+
+} // end of namespace analysis
+} // end of namespace snemo
+
+#endif // SNEMO_ANALYSIS_CELL_STATISTICS_H
+
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
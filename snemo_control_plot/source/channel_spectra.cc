@@ -0,0 +1,109 @@
+/// channel_spectra.cc
+
+// Ourselves:
+#include <channel_spectra.h>
+
+// Standard library:
+#include <stdexcept>
+
+// Third party:
+// - Bayeux/datatools:
+#include <bayeux/datatools/exception.h>
+
+namespace snemo {
+namespace analysis {
+
+  channel_spectra::channel_spectra()
+  {
+    reset();
+    return;
+  }
+
+  bool channel_spectra::is_initialized() const
+  {
+    return ! _counts_.empty();
+  }
+
+  void channel_spectra::initialize(size_t nchannels_, size_t nbins_, double min_, double max_)
+  {
+    DT_THROW_IF(nchannels_ == 0 || nbins_ == 0, std::logic_error,
+                "Invalid number of channels or bins !");
+    DT_THROW_IF(! (min_ < max_), std::logic_error, "Invalid binning range !");
+    _nchannels_ = nchannels_;
+    _nbins_     = nbins_;
+    _min_       = min_;
+    _max_       = max_;
+    _inv_width_ = nbins_ / (max_ - min_);
+    _counts_.assign(nchannels_ * nbins_, 0);
+    return;
+  }
+
+  void channel_spectra::reset()
+  {
+    _nchannels_ = 0;
+    _nbins_     = 0;
+    _min_       = 0.0;
+    _max_       = 0.0;
+    _inv_width_ = 0.0;
+    _counts_.clear();
+    return;
+  }
+
+  void channel_spectra::fill(size_t channel_, double value_)
+  {
+    // Direct index arithmetic, the comparisons also reject NaN values
+    const double u = (value_ - _min_) * _inv_width_;
+    if (! (u >= 0.0 && u < _nbins_) || channel_ >= _nchannels_) return;
+    _counts_[channel_ * _nbins_ + static_cast<size_t>(u)]++;
+    return;
+  }
+
+  void channel_spectra::clear()
+  {
+    _counts_.assign(_counts_.size(), 0);
+    return;
+  }
+
+  size_t channel_spectra::get_number_of_channels() const
+  {
+    return _nchannels_;
+  }
+
+  size_t channel_spectra::get_number_of_bins() const
+  {
+    return _nbins_;
+  }
+
+  double channel_spectra::get_min() const
+  {
+    return _min_;
+  }
+
+  double channel_spectra::get_max() const
+  {
+    return _max_;
+  }
+
+  double channel_spectra::get_bin_center(size_t bin_) const
+  {
+    return _min_ + (bin_ + 0.5) / _inv_width_;
+  }
+
+  uint32_t channel_spectra::get_count(size_t channel_, size_t bin_) const
+  {
+    DT_THROW_IF(channel_ >= _nchannels_ || bin_ >= _nbins_, std::range_error,
+                "Invalid channel " << channel_ << " or bin " << bin_ << " !");
+    return _counts_[channel_ * _nbins_ + bin_];
+  }
+
+} // end of namespace analysis
+} // end of namespace snemo
+
+// end of channel_spectra.cc
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
@@ -0,0 +1,107 @@
+/// \file channel_spectra.h
+/* Author(s)     : Xavier Garrido <garrido@lal.in2p3.fr>
+ * Creation date : 2026-10-18
+ * Last modified : 2026-10-18
+ *
+ * Copyright (C) 2026 Xavier Garrido <garrido@lal.in2p3.fr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * Description:
+ *
+ *   Spectra of many channels sharing the same linear binning, stored as one
+ *   dense (channel x bin) counter block. Values out of the binning range are
+ *   dropped.
+ *
+ * History:
+ *
+ */
+
+#ifndef SNEMO_ANALYSIS_CHANNEL_SPECTRA_H
+#define SNEMO_ANALYSIS_CHANNEL_SPECTRA_H 1
+
+// Standard library:
+#include <cstddef>
+#include <vector>
+#include <stdint.h>
+
+namespace snemo {
+namespace analysis {
+
+  /// \brief Dense block of per channel spectra
+  class channel_spectra
+  {
+  public:
+
+    /// Default constructor
+    channel_spectra();
+
+    /// Check if the counter block is allocated
+    bool is_initialized() const;
+
+    /// Allocate the counter block
+    void initialize(size_t nchannels_, size_t nbins_, double min_, double max_);
+
+    /// Release the counter block
+    void reset();
+
+    /// Add one count to a channel spectrum
+    void fill(size_t channel_, double value_);
+
+    /// Reset all counts to zero
+    void clear();
+
+    /// Return the number of channels
+    size_t get_number_of_channels() const;
+
+    /// Return the number of bins by channel
+    size_t get_number_of_bins() const;
+
+    /// Return the lower bound of the binning
+    double get_min() const;
+
+    /// Return the upper bound of the binning
+    double get_max() const;
+
+    /// Return the center of a bin
+    double get_bin_center(size_t bin_) const;
+
+    /// Return the number of counts of a channel bin
+    uint32_t get_count(size_t channel_, size_t bin_) const;
+
+  private:
+
+    size_t   _nchannels_;  //!< Number of channels
+    size_t   _nbins_;      //!< Number of bins by channel
+    double   _min_;        //!< Lower bound
+    double   _max_;        //!< Upper bound
+    double   _inv_width_;  //!< Inverse of the bin width
+    std::vector<uint32_t> _counts_; //!< Counts, channel major
+
+  };
+
+} // end of namespace analysis
+} // end of namespace snemo
+
+#endif // SNEMO_ANALYSIS_CHANNEL_SPECTRA_H
+
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
@@ -3,63 +3,85 @@
 // Ourselves:
 #include <geometry_tools.h>
 
+// Standard library:
+#include <map>
+#include <mutex>
+#include <utility>
+#include <algorithm>
+
 // - Bayeux/datatools:
 #include <bayeux/datatools/exception.h>
+#include <bayeux/datatools/logger.h>
 #include <bayeux/datatools/properties.h>
 #include <bayeux/datatools/service_manager.h>
 // - Bayeux/geomtools:
 #include <bayeux/geomtools/manager.h>
 #include <bayeux/geomtools/geometry_service.h>
+#include <bayeux/geomtools/id_mgr.h>
+#include <bayeux/geomtools/mapping.h>
 
 // - Falaise:
 #include <falaise/snemo/geometry/locator_plugin.h>
+#include <falaise/snemo/geometry/gg_locator.h>
+#include <falaise/snemo/geometry/calo_locator.h>
+#include <falaise/snemo/geometry/xcalo_locator.h>
+#include <falaise/snemo/geometry/gveto_locator.h>
 
 namespace snemo {
 namespace utils {
 
-  const snemo::geometry::gg_locator & geometry_tools::get_gg_locator() const
-  {
-    DT_THROW_IF(! is_initialized(), std::logic_error, "Geometry toolbox is not initialized!");
-    return _locator_plugin_->get_gg_locator();
-  }
-
-  const snemo::geometry::calo_locator & geometry_tools::get_calo_locator() const
-  {
-    DT_THROW_IF(! is_initialized(), std::logic_error, "Geometry toolbox is not initialized!");
-    return _locator_plugin_->get_calo_locator();
-  }
-
-  const snemo::geometry::xcalo_locator & geometry_tools::get_xcalo_locator() const
-  {
-    DT_THROW_IF(! is_initialized(), std::logic_error, "Geometry toolbox is not initialized!");
-    return _locator_plugin_->get_xcalo_locator();
-  }
-
-  const snemo::geometry::gveto_locator & geometry_tools::get_gveto_locator() const
-  {
-    DT_THROW_IF(! is_initialized(), std::logic_error, "Geometry toolbox is not initialized!");
-    return _locator_plugin_->get_gveto_locator();
-  }
-
-  bool geometry_tools::is_initialized() const
-  {
-    return _initialized_;
-  }
+  namespace {
+    /// Toolboxes already built, by geometry manager and locator plugin
+    typedef std::pair<const geomtools::manager *, std::string> toolbox_key_type;
+    std::map<toolbox_key_type, std::weak_ptr<const geometry_tools> > & toolboxes()
+    {
+      static std::map<toolbox_key_type, std::weak_ptr<const geometry_tools> > _toolboxes;
+      return _toolboxes;
+    }
+    std::mutex & toolboxes_mutex()
+    {
+      static std::mutex _mutex;
+      return _mutex;
+    }
 
-  geometry_tools::geometry_tools()
-  {
-    reset();
-    return;
+    /// Return the locator plugin name to be used (the first locator plugin if none is given)
+    std::string resolve_locator_plugin_name(const geomtools::manager & gmgr_,
+                                            const std::string & locator_plugin_name_)
+    {
+      if (! locator_plugin_name_.empty()) return locator_plugin_name_;
+      const geomtools::manager::plugins_dict_type & plugins = gmgr_.get_plugins();
+      for (geomtools::manager::plugins_dict_type::const_iterator ip = plugins.begin();
+           ip != plugins.end();
+           ip++) {
+        const std::string & plugin_name = ip->first;
+        if (gmgr_.is_plugin_a<snemo::geometry::locator_plugin>(plugin_name)) {
+          return plugin_name;
+        }
+      }
+      return locator_plugin_name_;
+    }
   }
 
-  geometry_tools::~geometry_tools()
+  geometry_tools::handle_type geometry_tools::fetch(const geomtools::manager & gmgr_,
+                                                    const std::string & locator_plugin_name_)
   {
-    reset();
-    return;
+    // Toolboxes are keyed by the resolved plugin name so that a default and an
+    // explicit name of the same plugin share the same toolbox
+    const std::string locator_plugin_name = resolve_locator_plugin_name(gmgr_, locator_plugin_name_);
+    // Only the lookup is locked: a toolbox is immutable once built
+    std::lock_guard<std::mutex> lock(toolboxes_mutex());
+    std::weak_ptr<const geometry_tools> & a_toolbox
+      = toolboxes()[std::make_pair(&gmgr_, locator_plugin_name)];
+    handle_type a_handle = a_toolbox.lock();
+    if (! a_handle) {
+      a_handle = std::make_shared<const geometry_tools>(gmgr_, locator_plugin_name);
+      a_toolbox = a_handle;
+    }
+    return a_handle;
   }
 
-  void geometry_tools::initialize(const datatools::properties & config_,
-                                  const datatools::service_manager & service_manager_)
+  geometry_tools::handle_type geometry_tools::fetch(const datatools::properties & config_,
+                                                    const datatools::service_manager & service_manager_)
   {
     // Geometry service
     std::string geometry_label;
@@ -75,47 +97,224 @@ namespace utils {
                 "Geometry toolbox has no '" << geometry_label << "' service !");
     const geomtools::geometry_service & Geo
       = service_manager_.get<geomtools::geometry_service>(geometry_label);
-    _geometry_manager_ = &(Geo.get_geom_manager());
 
     std::string locator_plugin_name;
     if (config_.has_key("locator_plugin_name")) {
       locator_plugin_name = config_.fetch_string("locator_plugin_name");
-    } else {
-      // If no locator plugin name is set, then search for the first one
-      const geomtools::manager::plugins_dict_type & plugins = _geometry_manager_->get_plugins();
-      for (geomtools::manager::plugins_dict_type::const_iterator ip = plugins.begin();
-           ip != plugins.end();
-           ip++) {
-        const std::string & plugin_name = ip->first;
-        if (_geometry_manager_->is_plugin_a<snemo::geometry::locator_plugin>(plugin_name)) {
-          locator_plugin_name = plugin_name;
-          break;
-        }
-      }
     }
+    return fetch(Geo.get_geom_manager(), locator_plugin_name);
+  }
+
+  geometry_tools::geometry_tools(const geomtools::manager & gmgr_,
+                                 const std::string & locator_plugin_name_)
+    : _geometry_manager_(gmgr_),
+      _locator_plugin_name_(resolve_locator_plugin_name(gmgr_, locator_plugin_name_))
+  {
     // Access to a given plugin by name and type :
-    DT_THROW_IF(! _geometry_manager_->has_plugin(locator_plugin_name) ||
-                ! _geometry_manager_->is_plugin_a<snemo::geometry::locator_plugin>(locator_plugin_name),
+    DT_THROW_IF(! _geometry_manager_.has_plugin(_locator_plugin_name_) ||
+                ! _geometry_manager_.is_plugin_a<snemo::geometry::locator_plugin>(_locator_plugin_name_),
                 std::logic_error,
-                "Found no locator plugin named '" << locator_plugin_name << "'");
-    _locator_plugin_ = &_geometry_manager_->get_plugin<snemo::geometry::locator_plugin>(locator_plugin_name);
+                "Found no locator plugin named '" << _locator_plugin_name_ << "'");
+    _locator_plugin_ = &_geometry_manager_.get_plugin<snemo::geometry::locator_plugin>(_locator_plugin_name_);
+
+    // Locators are resolved once for all
+    _gg_locator_    = &_locator_plugin_->get_gg_locator();
+    _calo_locator_  = &_locator_plugin_->get_calo_locator();
+    _xcalo_locator_ = &_locator_plugin_->get_xcalo_locator();
+    _gveto_locator_ = &_locator_plugin_->get_gveto_locator();
 
-    _initialized_ = true;
+    _build_channels_();
     return;
   }
 
-  void geometry_tools::reset()
+  uint64_t geometry_tools::_make_channel_key_(const geomtools::geom_id & gid_,
+                                              channel_category category_,
+                                              size_t nitems_)
+  {
+    // The category is stored in the upper 24 bits, so that channels are ordered
+    // by category first, and the address items in 8 bits items
+    if (nitems_ < 1 || nitems_ > 5 || gid_.get_depth() < nitems_) return 0;
+    uint64_t key = static_cast<uint64_t>(category_ + 1) << 40;
+    for (size_t i = 0; i < nitems_; i++) {
+      const uint32_t item = gid_.get(i);
+      if (item > 0xFF) return 0;
+      key |= static_cast<uint64_t>(item) << (8 * (4 - i));
+    }
+    return key;
+  }
+
+  bool geometry_tools::_find_channel_category_(const geomtools::geom_id & gid_,
+                                               channel_category & category_,
+                                               size_t & nitems_) const
+  {
+    const uint32_t a_type = gid_.get_type();
+    if (a_type == geomtools::geom_id::INVALID_TYPE) return false;
+    // Block parts are the same calorimeter channel
+    nitems_ = gid_.get_depth() - 1;
+    if (a_type == _gg_type_) {
+      category_ = GG_CHANNEL;
+      nitems_++;
+    } else if (a_type == _calo_type_) {
+      category_ = CALO_CHANNEL;
+    } else if (a_type == _xcalo_type_) {
+      category_ = XCALO_CHANNEL;
+    } else if (a_type == _gveto_type_) {
+      category_ = GVETO_CHANNEL;
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  void geometry_tools::_build_channels_()
   {
-    _geometry_manager_ = 0;
-    _locator_plugin_ = 0;
-    _initialized_ = false;
+    // Categories missing from the geometry are skipped
+    const geomtools::id_mgr & an_id_mgr = _geometry_manager_.get_id_mgr();
+    const char * categories[4] = { "drift_cell_core", "calorimeter_block", "xcalo_block", "gveto_block" };
+    uint32_t * types[4] = { &_gg_type_, &_calo_type_, &_xcalo_type_, &_gveto_type_ };
+    for (size_t i = 0; i < 4; i++) {
+      *types[i] = geomtools::geom_id::INVALID_TYPE;
+      if (an_id_mgr.has_category_info(categories[i])) {
+        *types[i] = an_id_mgr.get_category_info(categories[i]).get_type();
+      } else {
+        DT_LOG_WARNING(datatools::logger::PRIO_WARNING,
+                       "Geometry category '" << categories[i] << "' is missing: its channels are ignored !");
+      }
+    }
+
+    std::vector<std::pair<uint64_t, channel_type> > channels;
+    const geomtools::geom_info_dict_type & the_infos = _geometry_manager_.get_mapping().get_geom_infos();
+    for (geomtools::geom_info_dict_type::const_iterator i = the_infos.begin();
+         i != the_infos.end(); ++i) {
+      const geomtools::geom_id & a_gid = i->first;
+      channel_type a_channel;
+      size_t nitems = 0;
+      if (! _find_channel_category_(a_gid, a_channel.category, nitems)) continue;
+      a_channel.id = 0;
+      a_channel.gid = a_gid;
+      uint32_t a_side = 0;
+      switch (a_channel.category) {
+      case GG_CHANNEL:
+        a_side      = _gg_locator_->extract_side(a_gid);
+        a_channel.x = _gg_locator_->extract_layer(a_gid) + 1;
+        a_channel.y = _gg_locator_->extract_row(a_gid);
+        break;
+      case CALO_CHANNEL:
+        a_side      = _calo_locator_->extract_side(a_gid);
+        a_channel.x = _calo_locator_->extract_column(a_gid) + 1;
+        a_channel.y = _calo_locator_->extract_row(a_gid);
+        break;
+      case XCALO_CHANNEL:
+        a_side      = _xcalo_locator_->extract_side(a_gid);
+        a_channel.x = _xcalo_locator_->extract_column(a_gid) + 1;
+        a_channel.y = _xcalo_locator_->extract_row(a_gid);
+        break;
+      case GVETO_CHANNEL:
+        a_side      = _gveto_locator_->extract_side(a_gid);
+        a_channel.x = _gveto_locator_->extract_column(a_gid) + 1;
+        a_channel.y = _gveto_locator_->extract_wall(a_gid);
+        break;
+      }
+      if (a_channel.category != GG_CHANNEL) a_channel.gid.set_any(nitems);
+      if (a_side != snemo::geometry::utils::SIDE_BACK) a_channel.x = -a_channel.x;
+      const uint64_t key = _make_channel_key_(a_gid, a_channel.category, nitems);
+      DT_THROW_IF(key == 0, std::logic_error, "Channel '" << a_gid << "' can not be indexed !");
+      channels.push_back(std::make_pair(key, a_channel));
+    }
+    std::stable_sort(channels.begin(), channels.end(),
+                     [] (const std::pair<uint64_t, channel_type> & a_,
+                         const std::pair<uint64_t, channel_type> & b_) {
+                       return a_.first < b_.first;
+                     });
+    _number_of_gg_cells_ = 0;
+    size_t number_of_calo_blocks = 0;
+    for (size_t i = 0; i < channels.size(); i++) {
+      if (! _channel_keys_.empty() && _channel_keys_.back() == channels[i].first) continue;
+      channel_type & a_channel = channels[i].second;
+      a_channel.id = (a_channel.category == GG_CHANNEL
+                      ? _number_of_gg_cells_++ : number_of_calo_blocks++);
+      _channel_keys_.push_back(channels[i].first);
+      _channels_.push_back(a_channel);
+    }
     return;
   }
 
+  size_t geometry_tools::get_number_of_channels() const
+  {
+    return _channels_.size();
+  }
+
+  size_t geometry_tools::get_number_of_gg_cells() const
+  {
+    return _number_of_gg_cells_;
+  }
+
+  size_t geometry_tools::get_number_of_calo_blocks() const
+  {
+    return _channels_.size() - _number_of_gg_cells_;
+  }
+
+  int geometry_tools::get_channel_index(const geomtools::geom_id & gid_) const
+  {
+    channel_category a_category;
+    size_t nitems = 0;
+    if (! _find_channel_category_(gid_, a_category, nitems)) return -1;
+    const uint64_t key = _make_channel_key_(gid_, a_category, nitems);
+    const std::vector<uint64_t>::const_iterator found
+      = std::lower_bound(_channel_keys_.begin(), _channel_keys_.end(), key);
+    if (key == 0 || found == _channel_keys_.end() || *found != key) return -1;
+    return found - _channel_keys_.begin();
+  }
+
+  const geometry_tools::channel_type & geometry_tools::get_channel(size_t index_) const
+  {
+    DT_THROW_IF(index_ >= _channels_.size(), std::range_error,
+                "Invalid channel index " << index_ << " !");
+    return _channels_[index_];
+  }
+
+  const geometry_tools::channel_type & geometry_tools::get_calo_block(size_t id_) const
+  {
+    // Geiger cells come first in the channel table
+    DT_THROW_IF(_number_of_gg_cells_ + id_ >= _channels_.size(), std::range_error,
+                "Invalid calorimeter block index " << id_ << " !");
+    return _channels_[_number_of_gg_cells_ + id_];
+  }
+
+  const snemo::geometry::gg_locator & geometry_tools::get_gg_locator() const
+  {
+    return *_gg_locator_;
+  }
+
+  const snemo::geometry::calo_locator & geometry_tools::get_calo_locator() const
+  {
+    return *_calo_locator_;
+  }
+
+  const snemo::geometry::xcalo_locator & geometry_tools::get_xcalo_locator() const
+  {
+    return *_xcalo_locator_;
+  }
+
+  const snemo::geometry::gveto_locator & geometry_tools::get_gveto_locator() const
+  {
+    return *_gveto_locator_;
+  }
+
+  const geomtools::manager & geometry_tools::get_geometry_manager() const
+  {
+    return _geometry_manager_;
+  }
+
+  const std::string & geometry_tools::get_locator_plugin_name() const
+  {
+    return _locator_plugin_name_;
+  }
+
 } // end of namespace utils
 } // end of namespace snemo
 
-// end of snemo_control_plot_module.cc
+// end of geometry_tools.cc
 /*
 ** Local Variables: --
 ** mode: c++ --
@@ -1,7 +1,7 @@
 /// \file geometry_tools.h
 /* Author(s)     : Xavier Garrido <garrido@lal.in2p3.fr>
  * Creation date : 2016-03-24
- * Last modified : 2016-03-24
+ * Last modified : 2026-10-18
  *
  * Copyright (C) 2016 Xavier Garrido <garrido@lal.in2p3.fr>
  *
@@ -22,7 +22,16 @@
  *
  * Description:
  *
- *   Geometry tools singleton.
+ *   Geometry toolbox. A toolbox is an immutable read-only context for a
+ *   geometry manager and a locator plugin: locators are resolved at
+ *   construction and never change afterwards, so that a toolbox can be shared
+ *   by several modules and threads without locking. Toolboxes are obtained
+ *   through 'geometry_tools::fetch' which returns the toolbox already built
+ *   for the same geometry manager and locator plugin (an empty plugin name
+ *   standing for the first locator plugin) as long as one of its handles is
+ *   still alive, and builds a new one otherwise. The toolbox also holds a
+ *   table of the Geiger cells and calorimeter blocks giving, for each
+ *   channel, a dense index and its heatmap coordinates.
  *
  * History:
  *
@@ -31,8 +40,15 @@
 #ifndef SNEMO_UTILS_GEOMETRY_TOOLS_H
 #define SNEMO_UTILS_GEOMETRY_TOOLS_H 1
 
-// This project:
-#include <singleton.h>
+// Standard library:
+#include <string>
+#include <memory>
+#include <vector>
+#include <stdint.h>
+
+// Third party:
+// - Bayeux/geomtools:
+#include <bayeux/geomtools/geom_id.h>
 
 // Forward declaration
 namespace datatools {
@@ -55,10 +71,43 @@ namespace snemo {
 namespace utils {
 
   /// \brief Geometry toolbox
-  class geometry_tools : public ::snemo::utils::singleton<geometry_tools>
+  class geometry_tools
   {
   public:
 
+    /// Typedef for shared toolbox handle
+    typedef std::shared_ptr<const geometry_tools> handle_type;
+
+    /// Channel categories
+    enum channel_category {
+      GG_CHANNEL    = 0, //!< Geiger cell
+      CALO_CHANNEL  = 1, //!< Main wall calorimeter block
+      XCALO_CHANNEL = 2, //!< X-wall calorimeter block
+      GVETO_CHANNEL = 3  //!< Gamma veto calorimeter block
+    };
+
+    /// \brief Description of a channel
+    struct channel_type
+    {
+      channel_category category; //!< Channel category
+      size_t id; //!< Dense index among Geiger cells or among calorimeter blocks
+      int x; //!< Layer (Geiger) or column (calorimeter) number from 1, negative on front side
+      int y; //!< Row (Geiger, main and X-wall) or wall (gamma veto) number
+      geomtools::geom_id gid; //!< Geometry id of the channel (any block part)
+    };
+
+    /// Return the shared toolbox of a geometry manager and a locator plugin (built if needed)
+    static handle_type fetch(const geomtools::manager & gmgr_,
+                             const std::string & locator_plugin_name_ = "");
+
+    /// Return the toolbox of the geometry service given by configuration
+    static handle_type fetch(const datatools::properties & config_,
+                             const datatools::service_manager & service_manager_);
+
+    /// Constructor
+    explicit geometry_tools(const geomtools::manager & gmgr_,
+                            const std::string & locator_plugin_name_ = "");
+
     /// Return the Geiger locator
     const snemo::geometry::gg_locator & get_gg_locator() const;
 
@@ -71,32 +120,48 @@ namespace utils {
     /// Return the gamma veto calorimeter locator
     const snemo::geometry::gveto_locator & get_gveto_locator() const;
 
-    /// Check the geometry manager
-    bool has_geometry_manager() const;
-
-    /// Address the geometry manager
-    void set_geometry_manager(const geomtools::manager & gmgr_);
-
     /// Return a non-mutable reference to the geometry manager
     const geomtools::manager & get_geometry_manager() const;
 
-    /// Check if theclusterizer is initialized
-    bool is_initialized() const;
+    /// Return the name of the locator plugin
+    const std::string & get_locator_plugin_name() const;
+
+    /// Return the number of channels
+    size_t get_number_of_channels() const;
+
+    /// Return the number of Geiger cells
+    size_t get_number_of_gg_cells() const;
+
+    /// Return the number of calorimeter blocks
+    size_t get_number_of_calo_blocks() const;
 
-    /// The main initialization method (post-construction):
-    void initialize(const datatools::properties & config_,
-                    const datatools::service_manager & service_manager_);
+    /// Return the dense index of a Geiger cell or calorimeter block (-1 otherwise).
+    /// Channels are ordered by category (Geiger cells, main wall, X-wall and
+    /// gamma veto blocks) then by geometry address
+    int get_channel_index(const geomtools::geom_id & gid_) const;
 
-    /// The main termination method
-    void reset();
+    /// Return a channel given its index
+    const channel_type & get_channel(size_t index_) const;
+
+    /// Return a calorimeter block given its dense index among calorimeter blocks
+    const channel_type & get_calo_block(size_t id_) const;
 
   private:
 
-    /// Forbid default constructor
-    geometry_tools();
+    /// Build the channel table from the geometry mapping
+    void _build_channels_();
+
+    /// Find the channel category of a geom_id and its number of address items
+    bool _find_channel_category_(const geomtools::geom_id & gid_,
+                                 channel_category & category_,
+                                 size_t & nitems_) const;
+
+    /// Pack the category and the first address items of a geom_id (0 if it can not be packed)
+    static uint64_t _make_channel_key_(const geomtools::geom_id & gid_,
+                                       channel_category category_,
+                                       size_t nitems_);
 
-    /// Forbid destructor (done within singleton object)
-    virtual ~geometry_tools();
+  private:
 
     /// Non copyable constructor
     geometry_tools(const geometry_tools&);
@@ -104,13 +169,22 @@ namespace utils {
     /// Non-copyable assignation
     geometry_tools & operator=(const geometry_tools&);
 
-    /// Make the class singleton friend
-    friend class utils::singleton<geometry_tools>;
-
   private:
-    bool                                 _initialized_;       //!< Initialization status
-    const geomtools::manager *           _geometry_manager_;  //!< The SuperNEMO geometry manager
-    const snemo::geometry::locator_plugin * _locator_plugin_; //!< The SuperNEMO locator plugin
+
+    const geomtools::manager &              _geometry_manager_;    //!< The SuperNEMO geometry manager
+    std::string                             _locator_plugin_name_; //!< The name of the locator plugin
+    const snemo::geometry::locator_plugin * _locator_plugin_;      //!< The SuperNEMO locator plugin
+    const snemo::geometry::gg_locator *     _gg_locator_;          //!< The Geiger locator
+    const snemo::geometry::calo_locator *   _calo_locator_;        //!< The main wall calorimeter locator
+    const snemo::geometry::xcalo_locator *  _xcalo_locator_;       //!< The X-wall calorimeter locator
+    const snemo::geometry::gveto_locator *  _gveto_locator_;       //!< The gamma veto locator
+    uint32_t                                _gg_type_;             //!< Geometry type of Geiger cells
+    uint32_t                                _calo_type_;           //!< Geometry type of main wall blocks
+    uint32_t                                _xcalo_type_;          //!< Geometry type of X-wall blocks
+    uint32_t                                _gveto_type_;          //!< Geometry type of gamma veto blocks
+    size_t                                  _number_of_gg_cells_;  //!< Number of Geiger cells
+    std::vector<uint64_t>                   _channel_keys_;        //!< Sorted channel keys
+    std::vector<channel_type>               _channels_;            //!< Channels in key order
 
   };
 
@@ -53,6 +53,7 @@ namespace analysis {
   void snemo_control_plot_module::_set_defaults()
   {
     _histogram_pool_ = 0;
+    _geometry_tools_.reset();
     return;
   }
 
@@ -67,9 +68,8 @@ namespace analysis {
 
     dpp::base_module::_common_initialize(config_);
 
-    // Initialize geometry toolbox
-    snemo::utils::geometry_tools & a_geo_tb = snemo::utils::geometry_tools::get_instance();
-    a_geo_tb.initialize(config_, service_manager_);
+    // Geometry toolbox shared by all modules using the same geometry
+    _geometry_tools_ = snemo::utils::geometry_tools::fetch(config_, service_manager_);
 
     // Histogram service
     std::string histogram_label;
@@ -123,6 +123,7 @@ namespace analysis {
       }
       snemo::analysis::base_plotter * a_plotter = _plotters_.back();
       a_plotter->set_histogram_pool(grab_histogram_pool());
+      a_plotter->set_geometry_tools(*_geometry_tools_);
       datatools::properties a_config;
       config_.export_and_rename_starting_with(a_config, a_plotter_name + ".", "");
       a_plotter->initialize(a_config);
@@ -37,6 +37,9 @@
 // Data processing module abstract base class
 #include <dpp/base_module.h>
 
+// This project:
+#include <geometry_tools.h>
+
 // Forward declarations
 namespace mygsl {
   class histogram_pool;
@@ -87,6 +90,7 @@ namespace analysis {
 
     mygsl::histogram_pool * _histogram_pool_; //!< Histogram pool
     plotter_list_type _plotters_;             //!< List of plotters
+    snemo::utils::geometry_tools::handle_type _geometry_tools_; //!< Geometry toolbox
 
     // Macro to automate the registration of the module :
     DPP_MODULE_REGISTRATION_INTERFACE(snemo_control_plot_module);
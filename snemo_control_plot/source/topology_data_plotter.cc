@@ -6,7 +6,7 @@
 // Standard library
 #include <stdexcept>
 #include <string>
-#include <sstream>
+#include <algorithm>
 
 // Third party:
 // - Bayeux/datatools:
@@ -28,6 +28,40 @@
 namespace snemo {
 namespace analysis {
 
+  namespace {
+    /// Histogram name prefixes, by slot
+    const char * const SLOT_PREFIXES[topology_data_plotter::NUMBER_OF_SLOTS] = {
+      "TD::1e::",
+      "TD::1e1a::",
+      "TD::1e1g::",
+      "TD::1e2g::",
+      "TD::1e3g::",
+      "TD::2e::",
+      "TD::2e1g::",
+      "TD::2e2g::",
+      "TD::2e3g::"
+    };
+
+    /// Histogram names, by observable
+    const char * const OBSERVABLE_NAMES[topology_data_plotter::NUMBER_OF_OBSERVABLES] = {
+      "electron_energy",
+      "electron_track_length",
+      "electron_angle",
+      "alpha_delayed_time",
+      "alpha_track_length",
+      "gamma_energy",
+      "gamma_minimal_energy",
+      "gamma_mid_energy",
+      "gamma_maximal_energy",
+      "electron_minimal_energy",
+      "electron_maximal_energy",
+      "electrons_energy_sum",
+      "electrons_angle"
+    };
+  }
+
+  const size_t topology_data_plotter::MAX_GAMMAS;
+
   const std::string & topology_data_plotter::get_id()
   {
     static const std::string s("TDP");
@@ -52,6 +86,30 @@ namespace analysis {
   {
     ::snemo::analysis::base_plotter::_common_initialize(setup_);
 
+    // Resolve once the histograms declared in the pool
+    mygsl::histogram_pool & a_pool = grab_histogram_pool();
+    for (size_t i = 0; i < NUMBER_OF_SLOTS; i++) {
+      for (size_t j = 0; j < NUMBER_OF_OBSERVABLES; j++) {
+        const std::string a_key = std::string(SLOT_PREFIXES[i]) + OBSERVABLE_NAMES[j];
+        if (a_pool.has_1d(a_key)) _histograms_[i][j] = &a_pool.grab_1d(a_key);
+      }
+    }
+    const std::string a_key = std::string(SLOT_PREFIXES[SLOT_1E1G]) + "electron_energy_vs_gamma_energy";
+    if (a_pool.has_2d(a_key)) _electron_energy_vs_gamma_energy_ = &a_pool.grab_2d(a_key);
+
+    // Single dispatch on pattern id
+    _handlers_[snemo::datamodel::topology_1e_pattern::pattern_id()]
+      = &topology_data_plotter::_handle_1e_;
+    _handlers_[snemo::datamodel::topology_1e1a_pattern::pattern_id()]
+      = &topology_data_plotter::_handle_1e1a_;
+    _handlers_[snemo::datamodel::topology_1eNg_pattern::pattern_id()]
+      = &topology_data_plotter::_handle_1eNg_;
+    _handlers_[snemo::datamodel::topology_2e_pattern::pattern_id()]
+      = &topology_data_plotter::_handle_2e_;
+    _handlers_[snemo::datamodel::topology_2eNg_pattern::pattern_id()]
+      = &topology_data_plotter::_handle_2eNg_;
+    _gamma_energies_.reserve(MAX_GAMMAS);
+
     _set_initialized(true);
     return;
   }
@@ -85,6 +143,14 @@ namespace analysis {
   void topology_data_plotter::_set_defaults()
   {
     set_bank_label("TD");//snemo::datamodel::data_info::default_topology_data_label());
+    for (size_t i = 0; i < NUMBER_OF_SLOTS; i++) {
+      for (size_t j = 0; j < NUMBER_OF_OBSERVABLES; j++) {
+        _histograms_[i][j] = 0;
+      }
+    }
+    _electron_energy_vs_gamma_energy_ = 0;
+    _handlers_.clear();
+    _gamma_energies_.clear();
     return;
   }
 
@@ -95,171 +161,124 @@ namespace analysis {
 
     if (! td_.has_pattern()) return;
 
-    if (td_.has_pattern_as<snemo::datamodel::topology_1e_pattern>()) {
-      auto a_pattern = td_.get_pattern_as<snemo::datamodel::topology_1e_pattern>();
-      _plot_1e_(a_pattern);
-    }
-    if (td_.has_pattern_as<snemo::datamodel::topology_1e1a_pattern>()) {
-      auto a_pattern = td_.get_pattern_as<snemo::datamodel::topology_1e1a_pattern>();
-      _plot_1e1a_(a_pattern);
-    }
-    if (td_.has_pattern_as<snemo::datamodel::topology_1eNg_pattern>()) {
-      auto a_pattern = td_.get_pattern_as<snemo::datamodel::topology_1eNg_pattern>();
-      _plot_1eNg_(a_pattern);
-    }
-    if (td_.has_pattern_as<snemo::datamodel::topology_2e_pattern>()) {
-      auto a_pattern = td_.get_pattern_as<snemo::datamodel::topology_2e_pattern>();
-      _plot_2e_(a_pattern);
-    }
-    if (td_.has_pattern_as<snemo::datamodel::topology_2eNg_pattern>()) {
-      auto a_pattern = td_.get_pattern_as<snemo::datamodel::topology_2eNg_pattern>();
-      _plot_2eNg_(a_pattern);
+    const snemo::datamodel::base_topology_pattern & a_pattern = td_.get_pattern();
+    const auto found = _handlers_.find(a_pattern.get_pattern_id());
+    if (found == _handlers_.end()) {
+      DT_LOG_DEBUG(get_logging_priority(), "No plot for pattern '" << a_pattern.get_pattern_id() << "' !");
+      return;
     }
+    (this->*(found->second))(a_pattern);
     return;
   }
 
-  void topology_data_plotter::_plot_1e_(const snemo::datamodel::topology_1e_pattern & pattern_,
-                                        const std::string & prefix_)
+  void topology_data_plotter::_fill_(slot_type slot_, observable_type observable_, double value_)
   {
-    std::string a_key;
-    mygsl::histogram_pool & a_pool = grab_histogram_pool();
-    if (a_pool.has_1d(a_key = prefix_ + "electron_energy")) {
-      mygsl::histogram_1d & h1d = a_pool.grab_1d(a_key);
-      const double energy = pattern_.get_electron_energy();
-      if (datatools::is_valid(energy)) h1d.fill(energy);
-    }
-    if (a_pool.has_1d(a_key = prefix_ + "electron_track_length")) {
-      mygsl::histogram_1d & h1d = a_pool.grab_1d(a_key);
-      const double length = pattern_.get_electron_track_length();
-      if (datatools::is_valid(length)) h1d.fill(length);
-    }
-    if (a_pool.has_1d(a_key = prefix_ + "electron_angle")) {
-      mygsl::histogram_1d & h1d = a_pool.grab_1d(a_key);
-      const double angle = pattern_.get_electron_angle();
-      if (datatools::is_valid(angle)) h1d.fill(angle);
-    }
+    mygsl::histogram_1d * h1d = _histograms_[slot_][observable_];
+    if (h1d != 0 && datatools::is_valid(value_)) h1d->fill(value_);
     return;
   }
 
-  void topology_data_plotter::_plot_1e1a_(const snemo::datamodel::topology_1e1a_pattern & pattern_,
-                                          const std::string & prefix_)
+  void topology_data_plotter::_handle_1e_(const snemo::datamodel::base_topology_pattern & pattern_)
   {
-    _plot_1e_(pattern_, prefix_);
-    std::string a_key;
-    mygsl::histogram_pool & a_pool = grab_histogram_pool();
-    if (a_pool.has_1d(a_key = prefix_ + "alpha_delayed_time")) {
-      mygsl::histogram_1d & h1d = a_pool.grab_1d(a_key);
-      const double time = pattern_.get_alpha_delayed_time();
-      if (datatools::is_valid(time)) h1d.fill(time);
-    }
-    if (a_pool.has_1d(a_key = prefix_ + "alpha_track_length")) {
-      mygsl::histogram_1d & h1d = a_pool.grab_1d(a_key);
-      const double length = pattern_.get_alpha_track_length();
-      if (datatools::is_valid(length)) h1d.fill(length);
-    }
+    _plot_1e_(static_cast<const snemo::datamodel::topology_1e_pattern &>(pattern_), SLOT_1E);
+    return;
+  }
+
+  void topology_data_plotter::_handle_1e1a_(const snemo::datamodel::base_topology_pattern & pattern_)
+  {
+    const snemo::datamodel::topology_1e1a_pattern & a_pattern
+      = static_cast<const snemo::datamodel::topology_1e1a_pattern &>(pattern_);
+    _plot_1e_(a_pattern, SLOT_1E);
+    _plot_1e1a_(a_pattern);
+    return;
+  }
 
+  void topology_data_plotter::_handle_1eNg_(const snemo::datamodel::base_topology_pattern & pattern_)
+  {
+    const snemo::datamodel::topology_1eNg_pattern & a_pattern
+      = static_cast<const snemo::datamodel::topology_1eNg_pattern &>(pattern_);
+    _plot_1e_(a_pattern, SLOT_1E);
+    _plot_1eNg_(a_pattern);
+    return;
+  }
+
+  void topology_data_plotter::_handle_2e_(const snemo::datamodel::base_topology_pattern & pattern_)
+  {
+    _plot_2e_(static_cast<const snemo::datamodel::topology_2e_pattern &>(pattern_), SLOT_2E);
+    return;
+  }
+
+  void topology_data_plotter::_handle_2eNg_(const snemo::datamodel::base_topology_pattern & pattern_)
+  {
+    const snemo::datamodel::topology_2eNg_pattern & a_pattern
+      = static_cast<const snemo::datamodel::topology_2eNg_pattern &>(pattern_);
+    _plot_2e_(a_pattern, SLOT_2E);
+    _plot_2eNg_(a_pattern);
+    return;
+  }
+
+  void topology_data_plotter::_plot_1e_(const snemo::datamodel::topology_1e_pattern & pattern_,
+                                        slot_type slot_)
+  {
+    _fill_(slot_, ELECTRON_ENERGY, pattern_.get_electron_energy());
+    _fill_(slot_, ELECTRON_TRACK_LENGTH, pattern_.get_electron_track_length());
+    _fill_(slot_, ELECTRON_ANGLE, pattern_.get_electron_angle());
+    return;
+  }
+
+  void topology_data_plotter::_plot_1e1a_(const snemo::datamodel::topology_1e1a_pattern & pattern_)
+  {
+    _plot_1e_(pattern_, SLOT_1E1A);
+    _fill_(SLOT_1E1A, ALPHA_DELAYED_TIME, pattern_.get_alpha_delayed_time());
+    _fill_(SLOT_1E1A, ALPHA_TRACK_LENGTH, pattern_.get_alpha_track_length());
     return;
   }
 
-  void topology_data_plotter::_plot_1eNg_(const snemo::datamodel::topology_1eNg_pattern & pattern_,
-                                          const std::string & prefix_)
+  void topology_data_plotter::_plot_1eNg_(const snemo::datamodel::topology_1eNg_pattern & pattern_)
   {
     const size_t nbr_gammas = pattern_.get_number_of_gammas();
-    std::ostringstream a_prefix;
-    a_prefix << prefix_ << nbr_gammas << "g::";
-    _plot_1e_(pattern_, a_prefix.str());
+    if (nbr_gammas == 0 || nbr_gammas > MAX_GAMMAS) return;
+    const slot_type a_slot = static_cast<slot_type>(SLOT_1E1G + nbr_gammas - 1);
+    _plot_1e_(pattern_, a_slot);
 
-    // Fetch gamma energies
-    snemo::datamodel::topology_1eNg_pattern::energy_collection_type gammas_energies;
-    pattern_.fetch_gammas_energies(gammas_energies);
-    std::sort(gammas_energies.begin(), gammas_energies.end());
+    // Fetch gamma energies into the reused buffer
+    _gamma_energies_.clear();
+    pattern_.fetch_gammas_energies(_gamma_energies_);
+    if (_gamma_energies_.size() != nbr_gammas) return;
+    std::sort(_gamma_energies_.begin(), _gamma_energies_.end());
 
     if (nbr_gammas == 1) {
-      std::string a_key;
-      mygsl::histogram_pool & a_pool = grab_histogram_pool();
-      if (a_pool.has_1d(a_key = a_prefix.str() + "gamma_energy")) {
-        mygsl::histogram_1d & h1d = a_pool.grab_1d(a_key);
-        const double energy = gammas_energies.front();
-        if (datatools::is_valid(energy)) h1d.fill(energy);
-      }
-      if (a_pool.has_2d(a_key = a_prefix.str() + "electron_energy_vs_gamma_energy")) {
-        mygsl::histogram_2d & h2d = a_pool.grab_2d(a_key);
-        const double gamma_energy = gammas_energies.front();
-        const double electron_energy = pattern_.get_electron_energy();
-        if (datatools::is_valid(gamma_energy) &&
-            datatools::is_valid(electron_energy)) {
-          h2d.fill(gamma_energy, electron_energy);
-        }
-      }
-    } else if (nbr_gammas == 2) {
-      std::string a_key;
-      mygsl::histogram_pool & a_pool = grab_histogram_pool();
-      if (a_pool.has_1d(a_key = a_prefix.str() + "gamma_minimal_energy")) {
-        mygsl::histogram_1d & h1d = a_pool.grab_1d(a_key);
-        const double energy = gammas_energies.front();
-        if (datatools::is_valid(energy)) h1d.fill(energy);
-      }
-      if (a_pool.has_1d(a_key = a_prefix.str() + "gamma_maximal_energy")) {
-        mygsl::histogram_1d & h1d = a_pool.grab_1d(a_key);
-        const double energy = gammas_energies.back();
-        if (datatools::is_valid(energy)) h1d.fill(energy);
-      }
-    } else if (nbr_gammas == 3) {
-      std::string a_key;
-      mygsl::histogram_pool & a_pool = grab_histogram_pool();
-      if (a_pool.has_1d(a_key = a_prefix.str() + "gamma_minimal_energy")) {
-        mygsl::histogram_1d & h1d = a_pool.grab_1d(a_key);
-        const double energy = gammas_energies.front();
-        if (datatools::is_valid(energy)) h1d.fill(energy);
-      }
-      if (a_pool.has_1d(a_key = a_prefix.str() + "gamma_mid_energy")) {
-        mygsl::histogram_1d & h1d = a_pool.grab_1d(a_key);
-        const double energy = gammas_energies.at(2);
-        if (datatools::is_valid(energy)) h1d.fill(energy);
-      }
-      if (a_pool.has_1d(a_key = a_prefix.str() + "gamma_maximal_energy")) {
-        mygsl::histogram_1d & h1d = a_pool.grab_1d(a_key);
-        const double energy = gammas_energies.back();
-        if (datatools::is_valid(energy)) h1d.fill(energy);
+      const double gamma_energy = _gamma_energies_.front();
+      _fill_(a_slot, GAMMA_ENERGY, gamma_energy);
+      const double electron_energy = pattern_.get_electron_energy();
+      if (_electron_energy_vs_gamma_energy_ != 0 &&
+          datatools::is_valid(gamma_energy) &&
+          datatools::is_valid(electron_energy)) {
+        _electron_energy_vs_gamma_energy_->fill(gamma_energy, electron_energy);
       }
+    } else {
+      _fill_(a_slot, GAMMA_MINIMAL_ENERGY, _gamma_energies_.front());
+      if (nbr_gammas == 3) _fill_(a_slot, GAMMA_MID_ENERGY, _gamma_energies_[1]);
+      _fill_(a_slot, GAMMA_MAXIMAL_ENERGY, _gamma_energies_.back());
     }
     return;
   }
 
   void topology_data_plotter::_plot_2e_(const snemo::datamodel::topology_2e_pattern & pattern_,
-                                        const std::string & prefix_)
+                                        slot_type slot_)
   {
-    std::string a_key;
-    mygsl::histogram_pool & a_pool = grab_histogram_pool();
-    if (a_pool.has_1d(a_key = prefix_ + "electron_minimal_energy")) {
-      mygsl::histogram_1d & h1d = a_pool.grab_1d(a_key);
-      const double energy = pattern_.get_electron_minimal_energy();
-      if (datatools::is_valid(energy)) h1d.fill(energy);
-    }
-    if (a_pool.has_1d(a_key = prefix_ + "electron_maximal_energy")) {
-      mygsl::histogram_1d & h1d = a_pool.grab_1d(a_key);
-      const double energy = pattern_.get_electron_maximal_energy();
-      if (datatools::is_valid(energy)) h1d.fill(energy);
-    }
-    if (a_pool.has_1d(a_key = prefix_ + "electrons_energy_sum")) {
-      mygsl::histogram_1d & h1d = a_pool.grab_1d(a_key);
-      const double energy = pattern_.get_electrons_energy_sum();
-      if (datatools::is_valid(energy)) h1d.fill(energy);
-    }
-    if (a_pool.has_1d(a_key = prefix_ + "electrons_angle")) {
-      mygsl::histogram_1d & h1d = a_pool.grab_1d(a_key);
-      const double angle = pattern_.get_electrons_angle();
-      if (datatools::is_valid(angle)) h1d.fill(angle);
-    }
+    _fill_(slot_, ELECTRON_MINIMAL_ENERGY, pattern_.get_electron_minimal_energy());
+    _fill_(slot_, ELECTRON_MAXIMAL_ENERGY, pattern_.get_electron_maximal_energy());
+    _fill_(slot_, ELECTRONS_ENERGY_SUM, pattern_.get_electrons_energy_sum());
+    _fill_(slot_, ELECTRONS_ANGLE, pattern_.get_electrons_angle());
     return;
   }
 
-  void topology_data_plotter::_plot_2eNg_(const snemo::datamodel::topology_2eNg_pattern & pattern_,
-                                          const std::string & /*prefix_*/)
+  void topology_data_plotter::_plot_2eNg_(const snemo::datamodel::topology_2eNg_pattern & pattern_)
   {
-    std::ostringstream a_prefix;
-    a_prefix << "TD::2e" << pattern_.get_number_of_gammas() << "g::";
-    _plot_2e_(pattern_, a_prefix.str());
+    const size_t nbr_gammas = pattern_.get_number_of_gammas();
+    if (nbr_gammas == 0 || nbr_gammas > MAX_GAMMAS) return;
+    _plot_2e_(pattern_, static_cast<slot_type>(SLOT_2E1G + nbr_gammas - 1));
     return;
   }
 
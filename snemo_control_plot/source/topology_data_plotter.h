@@ -1,7 +1,7 @@
 /// \file topology_data_plotter.h
 /* Author(s)     : Xavier Garrido <garrido@lal.in2p3.fr>
  * Creation date : 2015-05-26
- * Last modified : 2015-05-26
+ * Last modified : 2026-10-18
  *
  * Copyright (C) 2015 Xavier Garrido <garrido@lal.in2p3.fr>
  *
@@ -31,13 +31,24 @@
 #ifndef SNEMO_ANALYSIS_TOPOLOGY_DATA_PLOTTER_H
 #define SNEMO_ANALYSIS_TOPOLOGY_DATA_PLOTTER_H 1
 
+// Standard library:
+#include <string>
+#include <vector>
+#include <unordered_map>
+
 // This project:
 #include <base_plotter.h>
 
+namespace mygsl {
+  class histogram_1d;
+  class histogram_2d;
+}
+
 namespace snemo {
 // Forward declaration:
 namespace datamodel {
   class topology_data;
+  class base_topology_pattern;
   class topology_1e_pattern;
   class topology_1eNg_pattern;
   class topology_1e1a_pattern;
@@ -80,27 +91,95 @@ namespace analysis {
     /// Specialized method for plotting 'TD' bank
     void _plot(const snemo::datamodel::topology_data & td_);
 
+  public:
+
+    /// Histogram sets, one by topology and gamma multiplicity
+    enum slot_type {
+      SLOT_1E = 0,
+      SLOT_1E1A,
+      SLOT_1E1G,
+      SLOT_1E2G,
+      SLOT_1E3G,
+      SLOT_2E,
+      SLOT_2E1G,
+      SLOT_2E2G,
+      SLOT_2E3G,
+      NUMBER_OF_SLOTS
+    };
+
+    /// Observables
+    enum observable_type {
+      ELECTRON_ENERGY = 0,
+      ELECTRON_TRACK_LENGTH,
+      ELECTRON_ANGLE,
+      ALPHA_DELAYED_TIME,
+      ALPHA_TRACK_LENGTH,
+      GAMMA_ENERGY,
+      GAMMA_MINIMAL_ENERGY,
+      GAMMA_MID_ENERGY,
+      GAMMA_MAXIMAL_ENERGY,
+      ELECTRON_MINIMAL_ENERGY,
+      ELECTRON_MAXIMAL_ENERGY,
+      ELECTRONS_ENERGY_SUM,
+      ELECTRONS_ANGLE,
+      NUMBER_OF_OBSERVABLES
+    };
+
+    /// Maximal number of gammas with dedicated histograms
+    static const size_t MAX_GAMMAS = 3;
+
   private:
 
+    /// Handler of a topology pattern type
+    typedef void (topology_data_plotter::*pattern_handler_type)
+      (const snemo::datamodel::base_topology_pattern & pattern_);
+
+    /// Fill the histogram of an observable if declared and if the value is valid
+    void _fill_(slot_type slot_, observable_type observable_, double value_);
+
+    /// Handler of '1e' topology pattern
+    void _handle_1e_(const snemo::datamodel::base_topology_pattern & pattern_);
+
+    /// Handler of '1e1a' topology pattern
+    void _handle_1e1a_(const snemo::datamodel::base_topology_pattern & pattern_);
+
+    /// Handler of '1eNg' topology pattern
+    void _handle_1eNg_(const snemo::datamodel::base_topology_pattern & pattern_);
+
+    /// Handler of '2e' topology pattern
+    void _handle_2e_(const snemo::datamodel::base_topology_pattern & pattern_);
+
+    /// Handler of '2eNg' topology pattern
+    void _handle_2eNg_(const snemo::datamodel::base_topology_pattern & pattern_);
+
     /// Dedicated plot method for '1e' topology pattern
-    void _plot_1e_(const snemo::datamodel::topology_1e_pattern & pattern_,
-                   const std::string & prefix_ = "TD::1e::");
+    void _plot_1e_(const snemo::datamodel::topology_1e_pattern & pattern_, slot_type slot_);
 
     /// Dedicated plot method for '1e1a' topology pattern
-    void _plot_1e1a_(const snemo::datamodel::topology_1e1a_pattern & pattern_,
-                     const std::string & prefix_ = "TD::1e1a::");
+    void _plot_1e1a_(const snemo::datamodel::topology_1e1a_pattern & pattern_);
 
     /// Dedicated plot method for '1eNg' topology pattern
-    void _plot_1eNg_(const snemo::datamodel::topology_1eNg_pattern & pattern_,
-                     const std::string & prefix_ = "TD::1e");
+    void _plot_1eNg_(const snemo::datamodel::topology_1eNg_pattern & pattern_);
 
     /// Dedicated plot method for '2e' topology pattern
-    void _plot_2e_(const snemo::datamodel::topology_2e_pattern & pattern_,
-                   const std::string & prefix_ = "TD::2e::");
+    void _plot_2e_(const snemo::datamodel::topology_2e_pattern & pattern_, slot_type slot_);
 
     /// Dedicated plot method for '2eNg' topology pattern
-    void _plot_2eNg_(const snemo::datamodel::topology_2eNg_pattern & pattern_,
-                     const std::string & prefix_ = "TD::2e");
+    void _plot_2eNg_(const snemo::datamodel::topology_2eNg_pattern & pattern_);
+
+  private:
+
+    /// Histograms by slot and observable (0 if not declared)
+    mygsl::histogram_1d * _histograms_[NUMBER_OF_SLOTS][NUMBER_OF_OBSERVABLES];
+
+    /// Electron energy versus gamma energy for '1e1g' topology
+    mygsl::histogram_2d * _electron_energy_vs_gamma_energy_;
+
+    /// Pattern handlers by pattern id
+    std::unordered_map<std::string, pattern_handler_type> _handlers_;
+
+    /// Gamma energies of the current pattern
+    std::vector<double> _gamma_energies_;
 
   };
 
@@ -20,6 +20,8 @@
 #include <falaise/snemo/datamodels/data_model.h>
 #include <falaise/snemo/datamodels/tracker_trajectory_data.h>
 #include <falaise/snemo/datamodels/helix_trajectory_pattern.h>
+#include <falaise/snemo/datamodels/line_trajectory_pattern.h>
+#include <falaise/snemo/datamodels/polyline_trajectory_pattern.h>
 
 namespace snemo {
 namespace analysis {
@@ -48,6 +50,18 @@ namespace analysis {
   {
     ::snemo::analysis::base_plotter::_common_initialize(setup_);
 
+    // Pattern handlers and histograms are resolved once for all
+    mygsl::histogram_pool & a_pool = grab_histogram_pool();
+    if (a_pool.has_1d("TTD::helix_radius")) {
+      _helix_radius_ = &a_pool.grab_1d("TTD::helix_radius");
+    }
+    _add_pattern_(snemo::datamodel::helix_trajectory_pattern::pattern_id(), "helix",
+                  &tracker_trajectory_data_plotter::_handle_helix_);
+    _add_pattern_(snemo::datamodel::line_trajectory_pattern::pattern_id(), "line",
+                  &tracker_trajectory_data_plotter::_handle_line_);
+    _add_pattern_(snemo::datamodel::polyline_trajectory_pattern::pattern_id(), "polyline",
+                  &tracker_trajectory_data_plotter::_handle_polyline_);
+
     _set_initialized(true);
     return;
   }
@@ -81,6 +95,9 @@ namespace analysis {
   void tracker_trajectory_data_plotter::_set_defaults()
   {
     set_bank_label(snemo::datamodel::data_info::default_tracker_trajectory_data_label());
+    _patterns_.clear();
+    _pattern_indexes_.clear();
+    _helix_radius_ = 0;
     return;
   }
 
@@ -90,30 +107,96 @@ namespace analysis {
     if (get_logging_priority() >= datatools::logger::PRIO_DEBUG) ttd_.tree_dump(std::clog);
 
     if (! ttd_.has_default_solution()) return;
-    auto a_default_solution = ttd_.get_default_solution();
+    const auto & a_default_solution = ttd_.get_default_solution();
     if (! a_default_solution.has_trajectories()) return;
-    auto trajectories = a_default_solution.get_trajectories();
-    for (auto itrajectory : trajectories) {
-      auto a_trajectory = itrajectory.get();
-      auto a_auxiliaries = a_trajectory.get_auxiliaries();
+    const auto & trajectories = a_default_solution.get_trajectories();
+    for (const auto & itrajectory : trajectories) {
+      const auto & a_trajectory = itrajectory.get();
+      const auto & a_auxiliaries = a_trajectory.get_auxiliaries();
       if (! a_auxiliaries.has_flag("default")) continue;
-      auto a_pattern_id = a_trajectory.get_pattern().get_pattern_id();
-      if (a_pattern_id != snemo::datamodel::helix_trajectory_pattern::pattern_id())
-        continue;
-      auto a_helix_pattern
-        = dynamic_cast<const snemo::datamodel::helix_trajectory_pattern&>(a_trajectory.get_pattern());
-      auto a_helix = a_helix_pattern.get_helix();
-      mygsl::histogram_pool & a_pool = grab_histogram_pool();
-      if (a_pool.has_1d("TTD::helix_radius")) {
-        mygsl::histogram_1d & h1d = a_pool.grab_1d("TTD::helix_radius");
-        h1d.fill(a_helix.get_radius());
+      const auto & a_pattern = a_trajectory.get_pattern();
+      const auto found = _pattern_indexes_.find(a_pattern.get_pattern_id());
+      if (found == _pattern_indexes_.end()) continue;
+      const pattern_entry_type & an_entry = _patterns_[found->second];
+
+      geomtools::vector_3d a_first;
+      geomtools::vector_3d a_last;
+      const double a_length = (this->*an_entry.handler)(a_pattern, a_first, a_last);
+      if (an_entry.length) an_entry.length->fill(a_length);
+      const geomtools::vector_3d a_direction = a_last - a_first;
+      if (an_entry.direction && a_direction.mag() > 0.0) {
+        an_entry.direction->fill(a_direction.x() / a_direction.mag());
+      }
+      if (an_entry.chi2 && a_auxiliaries.has_key("chi2")) {
+        double a_chi2 = a_auxiliaries.fetch_real("chi2");
+        if (a_auxiliaries.has_key("ndof")) {
+          const int a_ndof = a_auxiliaries.fetch_integer("ndof");
+          if (a_ndof > 0) a_chi2 /= a_ndof;
+        }
+        an_entry.chi2->fill(a_chi2);
+      }
+      if (an_entry.nhits && a_trajectory.has_cluster()) {
+        an_entry.nhits->fill(a_trajectory.get_cluster().get_hits().size());
       }
     }
 
+    return;
+  }
 
+  void tracker_trajectory_data_plotter::_add_pattern_(const std::string & pattern_id_,
+                                                      const std::string & label_,
+                                                      pattern_handler_type handler_)
+  {
+    mygsl::histogram_pool & a_pool = grab_histogram_pool();
+    const std::string prefix = "TTD::" + label_ + "::";
+    pattern_entry_type an_entry;
+    an_entry.handler   = handler_;
+    an_entry.length    = a_pool.has_1d(prefix + "length")    ? &a_pool.grab_1d(prefix + "length")    : 0;
+    an_entry.direction = a_pool.has_1d(prefix + "direction") ? &a_pool.grab_1d(prefix + "direction") : 0;
+    an_entry.chi2      = a_pool.has_1d(prefix + "chi2")      ? &a_pool.grab_1d(prefix + "chi2")      : 0;
+    an_entry.nhits     = a_pool.has_1d(prefix + "nhits")     ? &a_pool.grab_1d(prefix + "nhits")     : 0;
+    _pattern_indexes_[pattern_id_] = _patterns_.size();
+    _patterns_.push_back(an_entry);
     return;
   }
 
+  double tracker_trajectory_data_plotter::_handle_helix_(const snemo::datamodel::base_trajectory_pattern & pattern_,
+                                                         geomtools::vector_3d & first_,
+                                                         geomtools::vector_3d & last_)
+  {
+    // The pattern type is given by the pattern id
+    const auto & a_helix
+      = static_cast<const snemo::datamodel::helix_trajectory_pattern &>(pattern_).get_helix();
+    if (_helix_radius_) _helix_radius_->fill(a_helix.get_radius());
+    first_ = a_helix.get_first();
+    last_  = a_helix.get_last();
+    return a_helix.get_length();
+  }
+
+  double tracker_trajectory_data_plotter::_handle_line_(const snemo::datamodel::base_trajectory_pattern & pattern_,
+                                                        geomtools::vector_3d & first_,
+                                                        geomtools::vector_3d & last_)
+  {
+    const auto & a_segment
+      = static_cast<const snemo::datamodel::line_trajectory_pattern &>(pattern_).get_segment();
+    first_ = a_segment.get_first();
+    last_  = a_segment.get_last();
+    return a_segment.get_length();
+  }
+
+  double tracker_trajectory_data_plotter::_handle_polyline_(const snemo::datamodel::base_trajectory_pattern & pattern_,
+                                                            geomtools::vector_3d & first_,
+                                                            geomtools::vector_3d & last_)
+  {
+    const auto & a_path
+      = static_cast<const snemo::datamodel::polyline_trajectory_pattern &>(pattern_).get_path();
+    const int npoints = a_path.get_number_of_points();
+    if (npoints == 0) return 0.0;
+    first_ = a_path.get_point(0);
+    last_  = a_path.get_point(npoints - 1);
+    return a_path.get_length();
+  }
+
   void tracker_trajectory_data_plotter::init_ocd(datatools::object_configuration_description & ocd_)
   {
     // Invoke OCD support from parent class :
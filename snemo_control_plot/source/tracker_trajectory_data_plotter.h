@@ -1,7 +1,7 @@
 /// \file tracker_trajectory_data_plotter.h
 /* Author(s)     : Xavier Garrido <garrido@lal.in2p3.fr>
  * Creation date : 2015-05-25
- * Last modified : 2013-12-13
+ * Last modified : 2026-10-18
  *
  * Copyright (C) 2015 Xavier Garrido <garrido@lal.in2p3.fr>
  *
@@ -31,13 +31,27 @@
 #ifndef SNEMO_ANALYSIS_TRACKER_TRAJECTORY_DATA_PLOTTER_H
 #define SNEMO_ANALYSIS_TRACKER_TRAJECTORY_DATA_PLOTTER_H 1
 
+// Standard library:
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+// Third party:
+// - Bayeux/geomtools:
+#include <bayeux/geomtools/clhep.h>
+
 // This project:
 #include <base_plotter.h>
 
+namespace mygsl {
+  class histogram_1d;
+}
+
 namespace snemo {
 // Forward declaration:
 namespace datamodel {
   class tracker_trajectory_data;
+  class base_trajectory_pattern;
 }
 namespace analysis {
 
@@ -75,6 +89,46 @@ namespace analysis {
     /// Specialized method for plotting 'TTD' bank
     void _plot(const snemo::datamodel::tracker_trajectory_data & ttd_);
 
+  private:
+
+    /// Handler returning the length and the end points of a given pattern type
+    typedef double (tracker_trajectory_data_plotter::*pattern_handler_type)
+      (const snemo::datamodel::base_trajectory_pattern & pattern_,
+       geomtools::vector_3d & first_, geomtools::vector_3d & last_);
+
+    /// \brief Handler and histograms of a trajectory pattern type
+    struct pattern_entry_type
+    {
+      pattern_handler_type  handler;   //!< Pattern handler
+      mygsl::histogram_1d * length;    //!< Trajectory length
+      mygsl::histogram_1d * direction; //!< Cosine of the angle to the foil normal
+      mygsl::histogram_1d * chi2;      //!< Fit chi2 by degree of freedom
+      mygsl::histogram_1d * nhits;     //!< Number of Geiger hits
+    };
+
+    /// Register a pattern type with the histograms named after its label
+    void _add_pattern_(const std::string & pattern_id_,
+                       const std::string & label_,
+                       pattern_handler_type handler_);
+
+    /// Handler of helix patterns, also fills the helix radius
+    double _handle_helix_(const snemo::datamodel::base_trajectory_pattern & pattern_,
+                          geomtools::vector_3d & first_, geomtools::vector_3d & last_);
+
+    /// Handler of line patterns
+    double _handle_line_(const snemo::datamodel::base_trajectory_pattern & pattern_,
+                         geomtools::vector_3d & first_, geomtools::vector_3d & last_);
+
+    /// Handler of polyline patterns
+    double _handle_polyline_(const snemo::datamodel::base_trajectory_pattern & pattern_,
+                             geomtools::vector_3d & first_, geomtools::vector_3d & last_);
+
+  private:
+
+    std::vector<pattern_entry_type>         _patterns_;        //!< Pattern types
+    std::unordered_map<std::string, size_t> _pattern_indexes_; //!< Pattern type index by pattern id
+    mygsl::histogram_1d *                   _helix_radius_;    //!< Helix radius histogram
+
   };
 
 } // end of namespace analysis
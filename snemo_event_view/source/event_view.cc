@@ -0,0 +1,171 @@
+/// event_view.cc
+
+// Ourselves:
+#include <event_view.h>
+
+// Standard library:
+#include <stdexcept>
+
+// Third party:
+// - Bayeux/datatools:
+#include <datatools/exception.h>
+#include <datatools/things.h>
+// - Bayeux/mctools:
+#include <mctools/simulated_data.h>
+// - Falaise:
+#include <snemo/datamodels/data_model.h>
+#include <snemo/datamodels/event_header.h>
+#include <snemo/datamodels/calibrated_data.h>
+#include <snemo/datamodels/topology_data.h>
+
+namespace snemo {
+namespace analysis {
+
+  namespace {
+    /// Return a bank of a given type if present in the data record
+    template <class T>
+    const T * fetch_bank(const datatools::things & record_, const std::string & label_)
+    {
+      if (! record_.has(label_)) return 0;
+      if (! record_.is_a<T>(label_)) return 0;
+      return &record_.get<T>(label_);
+    }
+  }
+
+  event_view::event_view()
+  {
+    _record_ = 0;
+    _serial_ = 0;
+    _eh_ = 0;
+    _sd_ = 0;
+    _cd_ = 0;
+    _ptd_ = 0;
+    _td_ = 0;
+    return;
+  }
+
+  void event_view::reset(const datatools::things & record_)
+  {
+    clear();
+    _record_ = &record_;
+    _serial_++;
+    _eh_  = fetch_bank<snemo::datamodel::event_header>(record_,
+                                                       snemo::datamodel::data_info::default_event_header_label());
+    _sd_  = fetch_bank<mctools::simulated_data>(record_,
+                                                snemo::datamodel::data_info::default_simulated_data_label());
+    _cd_  = fetch_bank<snemo::datamodel::calibrated_data>(record_,
+                                                          snemo::datamodel::data_info::default_calibrated_data_label());
+    _ptd_ = fetch_bank<snemo::datamodel::particle_track_data>(record_,
+                                                              snemo::datamodel::data_info::default_particle_track_data_label());
+    _td_  = fetch_bank<snemo::datamodel::topology_data>(record_, "TD");
+    return;
+  }
+
+  void event_view::clear()
+  {
+    _record_ = 0;
+    _eh_ = 0;
+    _sd_ = 0;
+    _cd_ = 0;
+    _ptd_ = 0;
+    _td_ = 0;
+    // Derived indices are only flagged so that their memory is reused
+    for (auto & a_entry : _particles_) {
+      a_entry.built = false;
+      a_entry.particles.clear();
+    }
+    for (auto & a_entry : _step_hits_) {
+      a_entry.second.built = false;
+      a_entry.second.index.clear();
+    }
+    return;
+  }
+
+  bool event_view::has_record() const
+  {
+    return _record_ != 0;
+  }
+
+  uint64_t event_view::get_serial() const
+  {
+    return _serial_;
+  }
+
+  const datatools::things & event_view::get_record() const
+  {
+    DT_THROW_IF(! has_record(), std::logic_error, "No data record is bound to the view !");
+    return *_record_;
+  }
+
+  const snemo::datamodel::event_header * event_view::get_event_header() const
+  {
+    return _eh_;
+  }
+
+  const mctools::simulated_data * event_view::get_simulated_data() const
+  {
+    return _sd_;
+  }
+
+  const snemo::datamodel::calibrated_data * event_view::get_calibrated_data() const
+  {
+    return _cd_;
+  }
+
+  const snemo::datamodel::particle_track_data * event_view::get_particle_track_data() const
+  {
+    return _ptd_;
+  }
+
+  const snemo::datamodel::topology_data * event_view::get_topology_data() const
+  {
+    return _td_;
+  }
+
+  const event_view::particle_collection_type & event_view::get_particles(const uint32_t charge_)
+  {
+    particle_entry_type * an_entry = 0;
+    for (auto & a_entry : _particles_) {
+      if (a_entry.charge == charge_) {
+        an_entry = &a_entry;
+        break;
+      }
+    }
+    if (an_entry == 0) {
+      _particles_.push_back(particle_entry_type());
+      an_entry = &_particles_.back();
+      an_entry->charge = charge_;
+      an_entry->built = false;
+    }
+    if (! an_entry->built) {
+      if (_ptd_ != 0 && _ptd_->has_particles()) {
+        _ptd_->fetch_particles(an_entry->particles, charge_);
+      }
+      an_entry->built = true;
+    }
+    return an_entry->particles;
+  }
+
+  step_hit_index & event_view::grab_step_hits(const std::string & label_)
+  {
+    step_hit_entry_type & an_entry = _step_hits_[label_];
+    if (! an_entry.built) {
+      if (_sd_ != 0 && _sd_->has_step_hits(label_)) {
+        an_entry.index.build(_sd_->get_step_hits(label_));
+      }
+      an_entry.built = true;
+    }
+    return an_entry.index;
+  }
+
+} // namespace analysis
+} // namespace snemo
+
+// end of event_view.cc
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
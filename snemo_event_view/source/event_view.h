@@ -0,0 +1,160 @@
+/// \file event_view.h
+/* Author(s)     : Xavier Garrido <garrido@lal.in2p3.fr>
+ * Creation date : 2026-10-18
+ * Last modified : 2026-10-18
+ *
+ * Copyright (C) 2026 Xavier Garrido <garrido@lal.in2p3.fr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * Description:
+ *
+ *   Per event view of a data record. Bank pointers are resolved once when the
+ *   view is reset with a new record, and derived indices (particles by
+ *   charge, step hits by track) are built on first request. Several modules
+ *   sharing one view then walk the banks only once per event. Each reset increments a serial number so that a module
+ *   can check that the view has been bound to a new record since its last
+ *   call.
+ *
+ * History:
+ *
+ */
+
+#ifndef SNEMO_ANALYSIS_EVENT_VIEW_H
+#define SNEMO_ANALYSIS_EVENT_VIEW_H 1
+
+// Standard library:
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+
+// Third party:
+// - Falaise:
+#include <snemo/datamodels/particle_track_data.h>
+
+// This project:
+#include <step_hit_index.h>
+
+namespace datatools {
+  class things;
+}
+
+namespace mctools {
+  class simulated_data;
+}
+
+namespace snemo {
+  namespace datamodel {
+    class event_header;
+    class calibrated_data;
+    class topology_data;
+  }
+}
+
+namespace snemo {
+namespace analysis {
+
+  /// \brief Per event view of a data record
+  class event_view
+  {
+  public:
+
+    /// Typedef for particle collection
+    typedef snemo::datamodel::particle_track_data::particle_collection_type particle_collection_type;
+
+    /// Default constructor
+    event_view();
+
+    /// Bind the view to a new data record
+    void reset(const datatools::things & record_);
+
+    /// Unbind the view (memory is kept)
+    void clear();
+
+    /// Check if a data record is bound
+    bool has_record() const;
+
+    /// Return the number of records bound so far (incremented by each reset)
+    uint64_t get_serial() const;
+
+    /// Return the bound data record
+    const datatools::things & get_record() const;
+
+    /// Return the 'event_header' bank (0 if missing)
+    const snemo::datamodel::event_header * get_event_header() const;
+
+    /// Return the 'simulated_data' bank (0 if missing)
+    const mctools::simulated_data * get_simulated_data() const;
+
+    /// Return the 'calibrated_data' bank (0 if missing)
+    const snemo::datamodel::calibrated_data * get_calibrated_data() const;
+
+    /// Return the 'particle_track_data' bank (0 if missing)
+    const snemo::datamodel::particle_track_data * get_particle_track_data() const;
+
+    /// Return the 'topology_data' bank (0 if missing)
+    const snemo::datamodel::topology_data * get_topology_data() const;
+
+    /// Return the particles matching a charge mask
+    const particle_collection_type & get_particles(const uint32_t charge_);
+
+    /// Return the simulated step hits of a given label grouped by track
+    step_hit_index & grab_step_hits(const std::string & label_);
+
+  private:
+
+    /// Particles of a given charge mask
+    struct particle_entry_type
+    {
+      uint32_t charge;
+      bool     built;
+      particle_collection_type particles;
+    };
+
+    /// Step hits of a given label
+    struct step_hit_entry_type
+    {
+      bool           built;
+      step_hit_index index;
+    };
+
+    const datatools::things * _record_; //!< Bound data record
+    uint64_t _serial_;                  //!< Number of records bound so far
+
+    const snemo::datamodel::event_header          * _eh_;  //!< Event header bank
+    const mctools::simulated_data                 * _sd_;  //!< Simulated data bank
+    const snemo::datamodel::calibrated_data       * _cd_;  //!< Calibrated data bank
+    const snemo::datamodel::particle_track_data   * _ptd_; //!< Particle track data bank
+    const snemo::datamodel::topology_data         * _td_;  //!< Topology data bank
+
+    std::vector<particle_entry_type> _particles_;  //!< Particles by charge mask
+    std::map<std::string, step_hit_entry_type> _step_hits_; //!< Step hits by label
+
+  };
+
+} // namespace analysis
+} // namespace snemo
+
+#endif // SNEMO_ANALYSIS_EVENT_VIEW_H
+
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
@@ -0,0 +1,107 @@
+// event_view_module.cc
+
+// Ourselves:
+#include <event_view_module.h>
+
+// Standard library:
+#include <stdexcept>
+
+// Third party:
+// - Bayeux/datatools:
+#include <datatools/service_manager.h>
+
+// This project:
+#include <event_view_service.h>
+
+namespace snemo {
+namespace analysis {
+
+  // Registration instantiation macro :
+  DPP_MODULE_REGISTRATION_IMPLEMENT(event_view_module,
+                                    "snemo::analysis::event_view_module");
+
+  void event_view_module::_set_defaults()
+  {
+    _view_ = 0;
+    return;
+  }
+
+  // Initialization :
+  void event_view_module::initialize(const datatools::properties  & config_,
+                                     datatools::service_manager   & service_manager_,
+                                     dpp::module_handle_dict_type & /*module_dict_*/)
+  {
+    DT_THROW_IF(is_initialized(),
+                std::logic_error,
+                "Module '" << get_name() << "' is already initialized ! ");
+
+    dpp::base_module::_common_initialize(config_);
+
+    std::string view_label = "EventView";
+    if (config_.has_key("EventView_label")) {
+      view_label = config_.fetch_string("EventView_label");
+    }
+    DT_THROW_IF(! service_manager_.has(view_label) ||
+                ! service_manager_.is_a<event_view_service>(view_label),
+                std::logic_error,
+                "Module '" << get_name() << "' has no '" << view_label << "' service !");
+    _view_ = &service_manager_.grab<event_view_service>(view_label).grab_view();
+
+    // Tag the module as initialized :
+    _set_initialized(true);
+    return;
+  }
+
+  // Reset :
+  void event_view_module::reset()
+  {
+    DT_THROW_IF(! is_initialized(), std::logic_error,
+                "Module '" << get_name() << "' is not initialized !");
+
+    // Tag the module as un-initialized :
+    _set_initialized(false);
+    _view_->clear();
+    _set_defaults();
+    return;
+  }
+
+  // Constructor :
+  event_view_module::event_view_module(datatools::logger::priority logging_priority_)
+    : dpp::base_module(logging_priority_)
+  {
+    _set_defaults();
+    return;
+  }
+
+  // Destructor :
+  event_view_module::~event_view_module()
+  {
+    if (is_initialized()) event_view_module::reset();
+    return;
+  }
+
+  // Processing :
+  dpp::base_module::process_status event_view_module::process(datatools::things & data_record_)
+  {
+    DT_LOG_TRACE(get_logging_priority(), "Entering...");
+    DT_THROW_IF(! is_initialized(), std::logic_error,
+                "Module '" << get_name() << "' is not initialized !");
+
+    // Bank lookups and derived indices are refreshed once per record
+    _view_->reset(data_record_);
+
+    DT_LOG_TRACE(get_logging_priority(), "Exiting.");
+    return dpp::base_module::PROCESS_SUCCESS;
+  }
+
+} // namespace analysis
+} // namespace snemo
+
+// end of event_view_module.cc
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
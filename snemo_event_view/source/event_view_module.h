@@ -0,0 +1,89 @@
+/// \file event_view_module.h
+/* Author(s)     : Xavier Garrido <garrido@lal.in2p3.fr>
+ * Creation date : 2026-10-18
+ * Last modified : 2026-10-18
+ *
+ * Copyright (C) 2026 Xavier Garrido <garrido@lal.in2p3.fr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * Description:
+ *
+ *   A module binding the shared event view to each new data record. It must
+ *   run before any module using the view.
+ *
+ * History:
+ *
+ */
+
+#ifndef SNEMO_ANALYSIS_EVENT_VIEW_MODULE_H
+#define SNEMO_ANALYSIS_EVENT_VIEW_MODULE_H 1
+
+// Data processing module abstract base class
+#include <dpp/base_module.h>
+
+namespace snemo {
+namespace analysis {
+
+  class event_view;
+
+  class event_view_module : public dpp::base_module
+  {
+  public:
+
+    /// Constructor
+    event_view_module(datatools::logger::priority = datatools::logger::PRIO_FATAL);
+
+    /// Destructor
+    virtual ~event_view_module();
+
+    /// Initialization
+    virtual void initialize(const datatools::properties  & setup_,
+                            datatools::service_manager   & service_manager_,
+                            dpp::module_handle_dict_type & module_dict_);
+
+    /// Reset
+    virtual void reset();
+
+    /// Data record processing
+    virtual process_status process(datatools::things & data_);
+
+  protected:
+
+    /// Give default values to specific class members.
+    void _set_defaults();
+
+  private:
+
+    event_view * _view_; //!< Shared event view
+
+    // Macro to automate the registration of the module :
+    DPP_MODULE_REGISTRATION_INTERFACE(event_view_module);
+  };
+
+} // namespace analysis
+} // namespace snemo
+
+#endif // SNEMO_ANALYSIS_EVENT_VIEW_MODULE_H
+
+// end of event_view_module.h
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
@@ -0,0 +1,76 @@
+/// event_view_service.cc
+
+// Ourselves:
+#include <event_view_service.h>
+
+// Standard library:
+#include <stdexcept>
+
+// Third party:
+// - Bayeux/datatools:
+#include <datatools/exception.h>
+
+namespace snemo {
+namespace analysis {
+
+  // Registration instantiation macro :
+  DATATOOLS_SERVICE_REGISTRATION_IMPLEMENT(event_view_service,
+                                           "snemo::analysis::event_view_service");
+
+  event_view_service::event_view_service()
+  {
+    _initialized_ = false;
+    return;
+  }
+
+  event_view_service::~event_view_service()
+  {
+    if (is_initialized()) event_view_service::reset();
+    return;
+  }
+
+  bool event_view_service::is_initialized() const
+  {
+    return _initialized_;
+  }
+
+  int event_view_service::initialize(const datatools::properties & config_,
+                                     datatools::service_dict_type & /*service_dict_*/)
+  {
+    DT_THROW_IF(is_initialized(), std::logic_error,
+                "Service '" << get_name() << "' is already initialized !");
+    base_service::common_initialize(config_);
+    _initialized_ = true;
+    return datatools::SUCCESS;
+  }
+
+  int event_view_service::reset()
+  {
+    DT_THROW_IF(! is_initialized(), std::logic_error,
+                "Service '" << get_name() << "' is not initialized !");
+    _view_.clear();
+    _initialized_ = false;
+    return datatools::SUCCESS;
+  }
+
+  event_view & event_view_service::grab_view()
+  {
+    return _view_;
+  }
+
+  const event_view & event_view_service::get_view() const
+  {
+    return _view_;
+  }
+
+} // namespace analysis
+} // namespace snemo
+
+// end of event_view_service.cc
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
@@ -0,0 +1,93 @@
+/// \file event_view_service.h
+/* Author(s)     : Xavier Garrido <garrido@lal.in2p3.fr>
+ * Creation date : 2026-10-18
+ * Last modified : 2026-10-18
+ *
+ * Copyright (C) 2026 Xavier Garrido <garrido@lal.in2p3.fr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * Description:
+ *
+ *   A service holding the event view shared by analysis modules. The view is
+ *   bound to each new data record by the 'event_view_module' which has to be
+ *   the first module of the processing chain.
+ *
+ * History:
+ *
+ */
+
+#ifndef SNEMO_ANALYSIS_EVENT_VIEW_SERVICE_H
+#define SNEMO_ANALYSIS_EVENT_VIEW_SERVICE_H 1
+
+// Third party:
+// - Bayeux/datatools:
+#include <datatools/base_service.h>
+
+// This project:
+#include <event_view.h>
+
+namespace snemo {
+namespace analysis {
+
+  /// \brief Service sharing an event view between modules
+  class event_view_service : public datatools::base_service
+  {
+  public:
+
+    /// Constructor
+    event_view_service();
+
+    /// Destructor
+    virtual ~event_view_service();
+
+    /// Check initialization status
+    virtual bool is_initialized() const;
+
+    /// Initialization
+    virtual int initialize(const datatools::properties & config_,
+                           datatools::service_dict_type & service_dict_);
+
+    /// Reset
+    virtual int reset();
+
+    /// Return a mutable reference to the shared event view
+    event_view & grab_view();
+
+    /// Return a non mutable reference to the shared event view
+    const event_view & get_view() const;
+
+  private:
+
+    bool _initialized_; //!< Initialization flag
+    event_view _view_;  //!< Shared event view
+
+    // Registration interface :
+    DATATOOLS_SERVICE_REGISTRATION_INTERFACE(event_view_service);
+  };
+
+} // namespace analysis
+} // namespace snemo
+
+#endif // SNEMO_ANALYSIS_EVENT_VIEW_SERVICE_H
+
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
@@ -0,0 +1,158 @@
+/// step_hit_index.cc
+
+// Ourselves:
+#include <step_hit_index.h>
+
+// Standard library:
+#include <stdexcept>
+
+// Third party:
+// - Bayeux/datatools:
+#include <datatools/exception.h>
+
+namespace snemo {
+namespace analysis {
+
+  step_hit_index::step_hit_index()
+  {
+    _norphans_ = 0;
+    return;
+  }
+
+  int step_hit_index::get_particle_id(const std::string & name_)
+  {
+    const int id = find_particle_id(name_);
+    if (id >= 0) return id;
+    _particle_names_.push_back(name_);
+    return _particle_names_.size() - 1;
+  }
+
+  int step_hit_index::find_particle_id(const std::string & name_) const
+  {
+    // Only a handful of particle species are met in an event
+    for (size_t i = 0; i < _particle_names_.size(); i++) {
+      if (_particle_names_[i] == name_) return i;
+    }
+    return -1;
+  }
+
+  const std::string & step_hit_index::get_particle_name(const int particle_id_) const
+  {
+    DT_THROW_IF(particle_id_ < 0 || particle_id_ >= (int)_particle_names_.size(),
+                std::range_error, "Invalid particle id " << particle_id_ << " !");
+    return _particle_names_[particle_id_];
+  }
+
+  void step_hit_index::build(const hit_collection_type & hits_)
+  {
+    clear();
+
+    // Single pass over the collection: find the track of each step
+    _step_tracks_.resize(hits_.size());
+    for (size_t i = 0; i < hits_.size(); i++) {
+      const mctools::base_step_hit & a_hit = hits_[i].get();
+      if (! a_hit.has_track_id() || a_hit.get_track_id() < 0) {
+        _step_tracks_[i] = -1;
+        _norphans_++;
+        continue;
+      }
+      const size_t track_id = a_hit.get_track_id();
+      if (track_id >= _track_slots_.size()) _track_slots_.resize(track_id + 1, -1);
+      int & slot = _track_slots_[track_id];
+      if (slot < 0) {
+        // New track: the particle name is only looked up once per track
+        slot = _tracks_.size();
+        track_type a_track;
+        a_track.track_id    = track_id;
+        a_track.particle_id = get_particle_id(a_hit.get_particle_name());
+        a_track.primary     = a_hit.is_primary_particle();
+        a_track.begin       = 0;
+        a_track.end         = 0;
+        a_track.length      = 0.0;
+        _tracks_.push_back(a_track);
+      }
+      _tracks_[slot].end++;
+      _step_tracks_[i] = slot;
+    }
+
+    // Turn step counts into contiguous slices
+    size_t offset = 0;
+    for (auto & a_track : _tracks_) {
+      a_track.begin = offset;
+      offset += a_track.end;
+      a_track.end = a_track.begin;
+    }
+
+    // Scatter steps and their lengths into the slices
+    _steps_.resize(offset);
+    _lengths_.resize(offset);
+    for (size_t i = 0; i < hits_.size(); i++) {
+      if (_step_tracks_[i] < 0) continue;
+      const mctools::base_step_hit & a_hit = hits_[i].get();
+      const size_t j = _tracks_[_step_tracks_[i]].end++;
+      _steps_[j] = &a_hit;
+      _lengths_[j] = (a_hit.get_position_stop() - a_hit.get_position_start()).mag();
+    }
+
+    // Track lengths are plain sums over contiguous arrays
+    for (auto & a_track : _tracks_) {
+      const double * lengths = _lengths_.data();
+      double length = 0.0;
+      for (size_t j = a_track.begin; j < a_track.end; j++) {
+        length += lengths[j];
+      }
+      a_track.length = length;
+    }
+    return;
+  }
+
+  void step_hit_index::clear()
+  {
+    // Only release the slots used by the previous collection
+    for (const auto & a_track : _tracks_) {
+      _track_slots_[a_track.track_id] = -1;
+    }
+    _tracks_.clear();
+    _step_tracks_.clear();
+    _steps_.clear();
+    _lengths_.clear();
+    _norphans_ = 0;
+    return;
+  }
+
+  size_t step_hit_index::get_number_of_tracks() const
+  {
+    return _tracks_.size();
+  }
+
+  const step_hit_index::track_type & step_hit_index::get_track(const size_t track_) const
+  {
+    return _tracks_.at(track_);
+  }
+
+  size_t step_hit_index::get_number_of_orphan_steps() const
+  {
+    return _norphans_;
+  }
+
+  const mctools::base_step_hit & step_hit_index::get_step(const size_t step_) const
+  {
+    return *_steps_.at(step_);
+  }
+
+  double step_hit_index::get_step_length(const size_t step_) const
+  {
+    return _lengths_.at(step_);
+  }
+
+} // namespace analysis
+} // namespace snemo
+
+// end of step_hit_index.cc
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
@@ -0,0 +1,124 @@
+/// \file step_hit_index.h
+/* Author(s)     : Xavier Garrido <garrido@lal.in2p3.fr>
+ * Creation date : 2026-10-18
+ * Last modified : 2026-10-18
+ *
+ * Copyright (C) 2026 Xavier Garrido <garrido@lal.in2p3.fr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * Description:
+ *
+ *   Index of a simulated step hit collection grouped by track id. The
+ *   collection is walked once: particle names are interned to integer ids
+ *   when a new track is met and steps are then scattered into contiguous
+ *   per-track slices together with their lengths. The index does not depend
+ *   on the analysis module and keeps its memory from one event to the other.
+ *
+ * History:
+ *
+ */
+
+#ifndef SNEMO_ANALYSIS_STEP_HIT_INDEX_H
+#define SNEMO_ANALYSIS_STEP_HIT_INDEX_H 1
+
+// Standard library:
+#include <string>
+#include <vector>
+
+// Third party:
+// - Bayeux/mctools
+#include <mctools/simulated_data.h>
+
+namespace snemo {
+namespace analysis {
+
+  /// \brief Simulated step hits grouped by track id
+  class step_hit_index
+  {
+  public:
+
+    /// Typedef for step hit collection
+    typedef mctools::simulated_data::hit_handle_collection_type hit_collection_type;
+
+    /// Track entry
+    struct track_type
+    {
+      int    track_id;    //!< Geant4 track id
+      int    particle_id; //!< Interned particle name
+      bool   primary;     //!< Primary particle flag
+      size_t begin;       //!< First step index
+      size_t end;         //!< Past-the-end step index
+      double length;      //!< Sum of step lengths
+    };
+
+    /// Default constructor
+    step_hit_index();
+
+    /// Return the id of a particle name (registered if needed)
+    int get_particle_id(const std::string & name_);
+
+    /// Return the id of a particle name (-1 if unknown)
+    int find_particle_id(const std::string & name_) const;
+
+    /// Return the particle name of an id
+    const std::string & get_particle_name(const int particle_id_) const;
+
+    /// Index a step hit collection
+    void build(const hit_collection_type & hits_);
+
+    /// Remove indexed tracks (particle names and memory are kept)
+    void clear();
+
+    /// Return the number of tracks
+    size_t get_number_of_tracks() const;
+
+    /// Return a track (sorted by first appearance)
+    const track_type & get_track(const size_t track_) const;
+
+    /// Return the number of steps without track id in the last collection
+    size_t get_number_of_orphan_steps() const;
+
+    /// Return a step hit given its index within a track slice
+    const mctools::base_step_hit & get_step(const size_t step_) const;
+
+    /// Return the length of a step given its index within a track slice
+    double get_step_length(const size_t step_) const;
+
+  private:
+
+    std::vector<std::string> _particle_names_; //!< Interned particle names
+    std::vector<track_type>  _tracks_;         //!< Tracks by first appearance
+    std::vector<int>         _track_slots_;    //!< Track index by track id (-1 if none)
+    std::vector<int>         _step_tracks_;    //!< Track index of each step of the collection
+    std::vector<const mctools::base_step_hit *> _steps_; //!< Steps grouped by track
+    std::vector<double>      _lengths_;        //!< Step lengths grouped by track
+    size_t                   _norphans_;       //!< Number of steps without track id
+
+  };
+
+} // namespace analysis
+} // namespace snemo
+
+#endif // SNEMO_ANALYSIS_STEP_HIT_INDEX_H
+
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
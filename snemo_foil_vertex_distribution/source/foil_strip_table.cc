@@ -0,0 +1,116 @@
+/// foil_strip_table.cc
+
+// Ourselves:
+#include <foil_strip_table.h>
+
+// Standard library:
+#include <stdexcept>
+#include <algorithm>
+#include <utility>
+
+// Third party:
+// - Bayeux/datatools:
+#include <datatools/exception.h>
+// - Bayeux/geomtools:
+#include <geomtools/manager.h>
+#include <geomtools/id_mgr.h>
+#include <geomtools/mapping.h>
+#include <geomtools/logical_volume.h>
+#include <geomtools/box.h>
+
+namespace analysis {
+
+  foil_strip_table::foil_strip_table()
+  {
+    return;
+  }
+
+  void foil_strip_table::add_strip(const double ymin_, const double ymax_)
+  {
+    DT_THROW_IF(ymin_ >= ymax_, std::logic_error, "Invalid strip boundaries !");
+    const size_t i = std::upper_bound(_ymin_.begin(), _ymin_.end(), ymin_) - _ymin_.begin();
+    DT_THROW_IF((i > 0 && _ymax_[i-1] > ymin_) || (i < _ymin_.size() && ymax_ > _ymin_[i]),
+                std::logic_error, "Strip [" << ymin_ << ";" << ymax_ << "] overlaps another strip !");
+    _ymin_.insert(_ymin_.begin() + i, ymin_);
+    _ymax_.insert(_ymax_.begin() + i, ymax_);
+    return;
+  }
+
+  void foil_strip_table::build(const geomtools::manager & geo_mgr_,
+                               const std::string & strip_category_)
+  {
+    clear();
+    const geomtools::id_mgr & an_id_mgr = geo_mgr_.get_id_mgr();
+    DT_THROW_IF(! an_id_mgr.has_category_info(strip_category_), std::logic_error,
+                "Unknown geometry category '" << strip_category_ << "' !");
+    const int strip_type = an_id_mgr.get_category_info(strip_category_).get_type();
+
+    const geomtools::geom_info_dict_type & the_infos = geo_mgr_.get_mapping().get_geom_infos();
+    for (geomtools::geom_info_dict_type::const_iterator i = the_infos.begin();
+         i != the_infos.end(); ++i) {
+      if (i->first.get_type() != (uint32_t)strip_type) continue;
+      const geomtools::geom_info & a_info = i->second;
+      const geomtools::i_shape_3d & a_shape = a_info.get_logical().get_shape();
+      DT_THROW_IF(a_shape.get_shape_name() != "box", std::logic_error,
+                  "Source strip '" << i->first << "' is not a box !");
+      const geomtools::box & a_box = dynamic_cast<const geomtools::box &>(a_shape);
+      const double ycenter = a_info.get_world_placement().get_translation().y();
+      add_strip(ycenter - 0.5 * a_box.get_y(), ycenter + 0.5 * a_box.get_y());
+    }
+    DT_THROW_IF(_ymin_.empty(), std::logic_error,
+                "No source strip has been found in geometry mapping !");
+    return;
+  }
+
+  size_t foil_strip_table::size() const
+  {
+    return _ymin_.size();
+  }
+
+  void foil_strip_table::clear()
+  {
+    _ymin_.clear();
+    _ymax_.clear();
+    return;
+  }
+
+  int foil_strip_table::find_strip(const double y_) const
+  {
+    if (_ymin_.empty()) return -1;
+    // Branch-free search of the last lower boundary below y
+    const double * base = &_ymin_[0];
+    size_t n = _ymin_.size();
+    while (n > 1) {
+      const size_t half = n / 2;
+      base = (base[half] <= y_) ? base + half : base;
+      n -= half;
+    }
+    const size_t i = base - &_ymin_[0];
+    return (*base <= y_ && y_ < _ymax_[i]) ? (int)i : -1;
+  }
+
+  double foil_strip_table::get_ymin(const size_t strip_) const
+  {
+    return _ymin_.at(strip_);
+  }
+
+  double foil_strip_table::get_ymax(const size_t strip_) const
+  {
+    return _ymax_.at(strip_);
+  }
+
+  double foil_strip_table::get_center(const size_t strip_) const
+  {
+    return 0.5 * (_ymin_.at(strip_) + _ymax_.at(strip_));
+  }
+
+} // namespace analysis
+
+// end of foil_strip_table.cc
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
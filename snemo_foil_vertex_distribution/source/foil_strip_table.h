@@ -0,0 +1,96 @@
+/// \file foil_strip_table.h
+/* Author(s)     : Xavier Garrido <garrido@lal.in2p3.fr>
+ * Creation date : 2026-10-18
+ * Last modified : 2026-10-18
+ *
+ * Copyright (C) 2026 Xavier Garrido <garrido@lal.in2p3.fr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * Description:
+ *
+ *   Table of source foil strip boundaries along the y axis. The strips are
+ *   extracted from the geometry mapping and sorted so that the strip holding
+ *   a vertex is found by a branch-free binary search.
+ *
+ * History:
+ *
+ */
+
+#ifndef ANALYSIS_FOIL_STRIP_TABLE_H
+#define ANALYSIS_FOIL_STRIP_TABLE_H 1
+
+// Standard library:
+#include <string>
+#include <vector>
+
+namespace geomtools {
+  class manager;
+}
+
+namespace analysis {
+
+  /// \brief Sorted table of source foil strips
+  class foil_strip_table
+  {
+  public:
+
+    /// Default constructor
+    foil_strip_table();
+
+    /// Add a strip given its boundaries along y
+    void add_strip(const double ymin_, const double ymax_);
+
+    /// Build the table from the geometry mapping of a given category
+    void build(const geomtools::manager & geo_mgr_,
+               const std::string & strip_category_ = "source_strip");
+
+    /// Return the number of strips
+    size_t size() const;
+
+    /// Remove all strips
+    void clear();
+
+    /// Return the strip index holding y (-1 if outside any strip)
+    int find_strip(const double y_) const;
+
+    /// Return the lower y boundary of a strip
+    double get_ymin(const size_t strip_) const;
+
+    /// Return the upper y boundary of a strip
+    double get_ymax(const size_t strip_) const;
+
+    /// Return the y center of a strip
+    double get_center(const size_t strip_) const;
+
+  private:
+
+    std::vector<double> _ymin_; //!< Sorted lower boundaries
+    std::vector<double> _ymax_; //!< Upper boundaries
+
+  };
+
+} // namespace analysis
+
+#endif // ANALYSIS_FOIL_STRIP_TABLE_H
+
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
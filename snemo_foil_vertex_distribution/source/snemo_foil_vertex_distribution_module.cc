@@ -9,6 +9,11 @@
 // Third party:
 // - Bayeux/datatools:
 #include <datatools/service_manager.h>
+#include <datatools/utils.h>
+#include <datatools/clhep_units.h>
+// - Bayeux/geomtools:
+#include <geomtools/geometry_service.h>
+#include <geomtools/manager.h>
 // - Bayeux/mygsl
 #include <mygsl/histogram_pool.h>
 // - Bayeux/mtools
@@ -46,10 +51,35 @@ namespace analysis {
     return *_histogram_pool_;
   }
 
+  snemo_foil_vertex_distribution_module::vertex_mode_type
+  snemo_foil_vertex_distribution_module::get_vertex_mode(const std::string & label_)
+  {
+    if (label_ == "last")     return VERTEX_MODE_LAST;
+    if (label_ == "all")      return VERTEX_MODE_ALL;
+    if (label_ == "combined") return VERTEX_MODE_COMBINED;
+    return VERTEX_MODE_INVALID;
+  }
+
   void snemo_foil_vertex_distribution_module::_set_defaults()
   {
     _bank_label_     = "";
+    _vertex_mode_    = VERTEX_MODE_LAST;
+    _selected_vertices_.clear();
+    _vertex_histogram_       = 0;
+    _multiplicity_histogram_ = 0;
+    _paired_mode_    = false;
+    _truth_histogram_    = 0;
+    _reco_histogram_     = 0;
+    _residual_histogram_ = 0;
     _histogram_pool_ = 0;
+    _use_sparse_map_ = false;
+    _sparse_map_.clear();
+    _sparse_map_filename_.clear();
+    _sparse_map_exports_.clear();
+    _per_strip_ = false;
+    _strips_.clear();
+    _strip_histograms_.clear();
+    _strip_counts_ = 0;
     return;
   }
 
@@ -79,8 +109,13 @@ namespace analysis {
 
     dpp::base_module::_common_initialize(config_);
 
-    DT_THROW_IF(!config_.has_key("bank_label"), std::logic_error, "Missing bank label !");
-    _bank_label_ = config_.fetch_string("bank_label");
+    if (config_.has_key("paired_mode")) {
+      _paired_mode_ = config_.fetch_boolean("paired_mode");
+    }
+    if (! _paired_mode_) {
+      DT_THROW_IF(!config_.has_key("bank_label"), std::logic_error, "Missing bank label !");
+      _bank_label_ = config_.fetch_string("bank_label");
+    }
 
     // Service label
     std::string histogram_label;
@@ -114,6 +149,114 @@ namespace analysis {
       }
     }
 
+    // Selection of reconstructed foil vertices
+    if (config_.has_key("vertex_mode")) {
+      const std::string mode_label = config_.fetch_string("vertex_mode");
+      _vertex_mode_ = get_vertex_mode(mode_label);
+      DT_THROW_IF(_vertex_mode_ == VERTEX_MODE_INVALID, std::logic_error,
+                  "Unknown vertex mode '" << mode_label << "' !");
+    }
+    namespace sdm = snemo::datamodel;
+    if (_paired_mode_ || _bank_label_ == sdm::data_info::default_particle_track_data_label()) {
+      _multiplicity_histogram_ = &_grab_histogram_1d_("foil_vertex_multiplicity",
+                                                      "foil_vertex_multiplicity_template");
+    }
+    if (! _paired_mode_) {
+      _vertex_histogram_ = &_grab_histogram_2d_("foil_vertex_distribution",
+                                                "foil_vertex_distribution_template");
+    }
+
+    // True, reconstructed and residual distributions
+    if (_paired_mode_) {
+      std::string residual_template = "foil_vertex_residual_template";
+      if (config_.has_key("paired.residual_template")) {
+        residual_template = config_.fetch_string("paired.residual_template");
+      }
+      _truth_histogram_    = &_grab_histogram_2d_("foil_vertex_distribution_truth",
+                                                  "foil_vertex_distribution_template");
+      _reco_histogram_     = &_grab_histogram_2d_("foil_vertex_distribution_reco",
+                                                  "foil_vertex_distribution_template");
+      _residual_histogram_ = &_grab_histogram_2d_("foil_vertex_residual", residual_template);
+    }
+
+    // High resolution sparse map
+    if (config_.has_key("sparse_map.cell_size")) {
+      _use_sparse_map_ = true;
+      double cell_size = config_.fetch_real("sparse_map.cell_size");
+      if (! config_.has_explicit_unit("sparse_map.cell_size")) cell_size *= CLHEP::mm;
+      _sparse_map_.set_cell_size(cell_size);
+      if (config_.has_key("sparse_map.input_files")) {
+        // Merge maps from previous jobs
+        std::vector<std::string> input_files;
+        config_.fetch("sparse_map.input_files", input_files);
+        for (size_t i = 0; i < input_files.size(); i++) {
+          datatools::fetch_path_with_env(input_files[i]);
+          _sparse_map_.load(input_files[i]);
+        }
+      }
+      if (config_.has_key("sparse_map.output_file")) {
+        _sparse_map_filename_ = config_.fetch_string("sparse_map.output_file");
+        datatools::fetch_path_with_env(_sparse_map_filename_);
+      }
+      if (config_.has_key("sparse_map.export_templates")) {
+        config_.fetch("sparse_map.export_templates", _sparse_map_exports_);
+      }
+    }
+
+    // Per strip distributions
+    if (config_.has_key("per_strip")) {
+      _per_strip_ = config_.fetch_boolean("per_strip");
+    }
+    if (_per_strip_) {
+      // Geometry manager :
+      std::string geo_label = snemo::processing::service_info::default_geometry_service_label();
+      if (config_.has_key("Geo_label")) {
+        geo_label = config_.fetch_string("Geo_label");
+      }
+      DT_THROW_IF(geo_label.empty(), std::logic_error,
+                  "Module '" << get_name() << "' has no valid '" << "Geo_label" << "' property !");
+      DT_THROW_IF(! service_manager_.has(geo_label) ||
+                  ! service_manager_.is_a<geomtools::geometry_service>(geo_label),
+                  std::logic_error,
+                  "Module '" << get_name() << "' has no '" << geo_label << "' service !");
+      const geomtools::geometry_service & Geo
+        = service_manager_.get<geomtools::geometry_service>(geo_label);
+
+      std::string strip_category = "source_strip";
+      if (config_.has_key("strips.category")) {
+        strip_category = config_.fetch_string("strips.category");
+      }
+      _strips_.build(Geo.get_geom_manager(), strip_category);
+      DT_LOG_DEBUG(get_logging_priority(), "Number of source strips = " << _strips_.size());
+
+      std::string strip_template = "foil_strip_vertex_distribution_template";
+      if (config_.has_key("strips.histogram_template")) {
+        strip_template = config_.fetch_string("strips.histogram_template");
+      }
+
+      // Build per strip histograms once for all
+      mygsl::histogram_pool & a_pool = *_histogram_pool_;
+      for (size_t i = 0; i < _strips_.size(); i++) {
+        std::ostringstream key;
+        key << "foil_strip_" << i << "_vertex_distribution";
+        if (! a_pool.has(key.str())) {
+          mygsl::histogram_2d & h = a_pool.add_2d(key.str(), "", "foil_strips");
+          datatools::properties hconfig;
+          hconfig.store_string("mode", "mimic");
+          hconfig.store_string("mimic.histogram_2d", strip_template);
+          mygsl::histogram_pool::init_histo_2d(h, hconfig, &a_pool);
+        }
+        _strip_histograms_.push_back(&a_pool.grab_2d(key.str()));
+      }
+      // Vertices outside strips are counted in the bin -1
+      const std::string counts_key = "foil_strip_counts";
+      if (! a_pool.has(counts_key)) {
+        mygsl::histogram_1d & h = a_pool.add_1d(counts_key, "", "foil_strips");
+        h.initialize(_strips_.size() + 1, -1.5, _strips_.size() - 0.5);
+      }
+      _strip_counts_ = &a_pool.grab_1d(counts_key);
+    }
+
     // Tag the module as initialized :
     _set_initialized(true);
     return;
@@ -132,6 +275,27 @@ namespace analysis {
       dump_result(std::clog);
     }
 
+    if (_use_sparse_map_) {
+      DT_LOG_DEBUG(get_logging_priority(), "Sparse vertex map holds "
+                   << _sparse_map_.get_number_of_cells() << " cells");
+      if (! _sparse_map_filename_.empty()) {
+        _sparse_map_.store(_sparse_map_filename_);
+      }
+      // Export the sparse map into histograms with the template binnings
+      for (size_t i = 0; i < _sparse_map_exports_.size(); i++) {
+        const std::string & a_template = _sparse_map_exports_[i];
+        std::string key_str = a_template;
+        const std::string suffix = "_template";
+        if (key_str.size() > suffix.size()
+            && key_str.compare(key_str.size() - suffix.size(), suffix.size(), suffix) == 0) {
+          key_str.erase(key_str.size() - suffix.size());
+        } else {
+          key_str += "_sparse";
+        }
+        _sparse_map_.export_histogram(_grab_histogram_2d_(key_str, a_template));
+      }
+    }
+
     _set_defaults();
     // Tag the module as un-initialized :
     _set_initialized(false);
@@ -145,69 +309,165 @@ namespace analysis {
     DT_THROW_IF (! is_initialized(), std::logic_error,
                  "Module '" << get_name() << "' is not initialized !");
 
+    namespace sdm = snemo::datamodel;
+    if (_paired_mode_) {
+      const std::string & sd_label  = sdm::data_info::default_simulated_data_label();
+      const std::string & ptd_label = sdm::data_info::default_particle_track_data_label();
+      if (!data_record_.has(sd_label) || !data_record_.has(ptd_label)) {
+        DT_LOG_ERROR(get_logging_priority(),
+                     "Could not find '" << sd_label << "' and '" << ptd_label << "' banks !");
+        return dpp::base_module::PROCESS_STOP;
+      }
+      const geomtools::vector_3d * true_vertex = _get_true_vertex_(data_record_, sd_label);
+      if (true_vertex == 0) {
+        DT_LOG_WARNING(get_logging_priority(), "No vertex has been set !");
+        return dpp::base_module::PROCESS_STOP;
+      }
+      // All true vertices are kept to get the reconstruction acceptance. They
+      // only go to the truth histogram: the sparse map and the per strip
+      // distributions (filled by _fill_vertex_) only hold reconstructed
+      // vertices in paired mode
+      _truth_histogram_->fill(true_vertex->y(), true_vertex->z());
+      _select_reconstructed_vertices_(data_record_, ptd_label);
+      for (size_t i = 0; i < _selected_vertices_.size(); i++) {
+        const geomtools::vector_3d & reco_vertex = _selected_vertices_[i];
+        _fill_vertex_(*_reco_histogram_, reco_vertex);
+        _residual_histogram_->fill(reco_vertex.y() - true_vertex->y(),
+                                   reco_vertex.z() - true_vertex->z());
+      }
+      return dpp::base_module::PROCESS_SUCCESS;
+    }
+
     if (!data_record_.has(_bank_label_)) {
       DT_LOG_ERROR(get_logging_priority(),
                    "Could not find any bank with label '" << _bank_label_ << "' !");
       return dpp::base_module::PROCESS_STOP;
     }
 
-    const geomtools::vector_3d * vertex = 0;
-    namespace sdm = snemo::datamodel;
     if (_bank_label_ == sdm::data_info::default_simulated_data_label()) {
-      // Check if the 'calibrated data' record bank is available :
-      const mctools::simulated_data & sd
-        = data_record_.get<mctools::simulated_data>(_bank_label_);
-
-      if (sd.has_vertex()) vertex = &(sd.get_vertex());
+      const geomtools::vector_3d * vertex = _get_true_vertex_(data_record_, _bank_label_);
+      if (vertex == 0) {
+        DT_LOG_WARNING(get_logging_priority(), "No vertex has been set !");
+        return dpp::base_module::PROCESS_STOP;
+      }
+      _fill_vertex_(*_vertex_histogram_, *vertex);
     } else if (_bank_label_ == sdm::data_info::default_particle_track_data_label()) {
-      const sdm::particle_track_data & ptd
-        = data_record_.get<sdm::particle_track_data>(_bank_label_);
-      // Loop over all saved particles
-      const sdm::particle_track_data::particle_collection_type & the_particles
-        = ptd.get_particles ();
-      for (sdm::particle_track_data::particle_collection_type::const_iterator
-             iparticle = the_particles.begin();
-           iparticle != the_particles.end();
-           ++iparticle) {
-        const sdm::particle_track & a_particle = iparticle->get();
-        if (!a_particle.has_vertices()) continue;
-
-        const sdm::particle_track::vertex_collection_type & the_vertices
-          = a_particle.get_vertices ();
-        for (sdm::particle_track::vertex_collection_type::const_iterator
-               ivertex = the_vertices.begin();
-             ivertex != the_vertices.end(); ++ivertex) {
-          const geomtools::blur_spot & a_vertex = ivertex->get ();
-          if (!sdm::particle_track::vertex_is_on_source_foil(a_vertex)) continue;
-          vertex = &(a_vertex.get_position());
-        }
+      _select_reconstructed_vertices_(data_record_, _bank_label_);
+      if (_selected_vertices_.empty()) {
+        DT_LOG_WARNING(get_logging_priority(), "No vertex has been set !");
+        return dpp::base_module::PROCESS_STOP;
+      }
+      for (size_t i = 0; i < _selected_vertices_.size(); i++) {
+        _fill_vertex_(*_vertex_histogram_, _selected_vertices_[i]);
       }
     } else {
       DT_THROW_IF(true, std::logic_error,
                   "Bank label '" << _bank_label_ << "' is not supported !");
     }
 
-    if (vertex == 0) {
-      DT_LOG_WARNING(get_logging_priority(), "No vertex has been set !");
-      return dpp::base_module::PROCESS_STOP;
+    return dpp::base_module::PROCESS_SUCCESS;
+  }
+
+  const geomtools::vector_3d *
+  snemo_foil_vertex_distribution_module::_get_true_vertex_(const datatools::things & data_,
+                                                           const std::string & bank_label_)
+  {
+    const mctools::simulated_data & sd = data_.get<mctools::simulated_data>(bank_label_);
+    return sd.has_vertex() ? &(sd.get_vertex()) : 0;
+  }
+
+  size_t
+  snemo_foil_vertex_distribution_module::_select_reconstructed_vertices_(const datatools::things & data_,
+                                                                         const std::string & bank_label_)
+  {
+    namespace sdm = snemo::datamodel;
+    _selected_vertices_.clear();
+    size_t nvertices = 0;
+    geomtools::vector_3d barycenter(0.0, 0.0, 0.0);
+    const sdm::particle_track_data & ptd = data_.get<sdm::particle_track_data>(bank_label_);
+    // Loop over all saved particles
+    const sdm::particle_track_data::particle_collection_type & the_particles
+      = ptd.get_particles ();
+    for (sdm::particle_track_data::particle_collection_type::const_iterator
+           iparticle = the_particles.begin();
+         iparticle != the_particles.end();
+         ++iparticle) {
+      const sdm::particle_track & a_particle = iparticle->get();
+      if (!a_particle.has_vertices()) continue;
+
+      const sdm::particle_track::vertex_collection_type & the_vertices
+        = a_particle.get_vertices ();
+      for (sdm::particle_track::vertex_collection_type::const_iterator
+             ivertex = the_vertices.begin();
+           ivertex != the_vertices.end(); ++ivertex) {
+        const geomtools::blur_spot & a_vertex = ivertex->get ();
+        if (!sdm::particle_track::vertex_is_on_source_foil(a_vertex)) continue;
+        const geomtools::vector_3d & a_position = a_vertex.get_position();
+        nvertices++;
+        if (_vertex_mode_ == VERTEX_MODE_COMBINED) {
+          barycenter += a_position;
+        } else if (_vertex_mode_ == VERTEX_MODE_ALL || _selected_vertices_.empty()) {
+          _selected_vertices_.push_back(a_position);
+        } else {
+          // Last vertex wins
+          _selected_vertices_.back() = a_position;
+        }
+      }
+    }
+    if (_vertex_mode_ == VERTEX_MODE_COMBINED && nvertices > 0) {
+      _selected_vertices_.push_back(barycenter / nvertices);
     }
-    // Getting histogram pool
-    mygsl::histogram_pool & a_pool = grab_histogram_pool();
+    _multiplicity_histogram_->fill(nvertices);
+    return nvertices;
+  }
 
-    const std::string & key_str = "foil_vertex_distribution";
-    if (!a_pool.has(key_str)) {
-      mygsl::histogram_2d & h = a_pool.add_2d(key_str);
+  mygsl::histogram_1d &
+  snemo_foil_vertex_distribution_module::_grab_histogram_1d_(const std::string & key_,
+                                                             const std::string & template_)
+  {
+    mygsl::histogram_pool & a_pool = *_histogram_pool_;
+    if (! a_pool.has(key_)) {
+      mygsl::histogram_1d & h = a_pool.add_1d(key_);
       datatools::properties hconfig;
       hconfig.store_string("mode", "mimic");
-      hconfig.store_string("mimic.histogram_2d", "foil_vertex_distribution_template");
+      hconfig.store_string("mimic.histogram_1d", template_);
+      mygsl::histogram_pool::init_histo_1d(h, hconfig, &a_pool);
+    }
+    return a_pool.grab_1d(key_);
+  }
+
+  mygsl::histogram_2d &
+  snemo_foil_vertex_distribution_module::_grab_histogram_2d_(const std::string & key_,
+                                                             const std::string & template_)
+  {
+    mygsl::histogram_pool & a_pool = *_histogram_pool_;
+    if (! a_pool.has(key_)) {
+      mygsl::histogram_2d & h = a_pool.add_2d(key_);
+      datatools::properties hconfig;
+      hconfig.store_string("mode", "mimic");
+      hconfig.store_string("mimic.histogram_2d", template_);
       mygsl::histogram_pool::init_histo_2d(h, hconfig, &a_pool);
     }
+    return a_pool.grab_2d(key_);
+  }
 
-    // Getting the current histogram
-    mygsl::histogram_2d & a_histo = a_pool.grab_2d(key_str);
-    a_histo.fill(vertex->y(), vertex->z());
+  void snemo_foil_vertex_distribution_module::_fill_vertex_(mygsl::histogram_2d & histo_,
+                                                            const geomtools::vector_3d & vertex_)
+  {
+    histo_.fill(vertex_.y(), vertex_.z());
 
-    return dpp::base_module::PROCESS_SUCCESS;
+    if (_use_sparse_map_) {
+      _sparse_map_.fill(vertex_.y(), vertex_.z());
+    }
+
+    if (_per_strip_) {
+      const int istrip = _strips_.find_strip(vertex_.y());
+      _strip_counts_->fill(istrip);
+      if (istrip >= 0) {
+        _strip_histograms_[istrip]->fill(vertex_.y() - _strips_.get_center(istrip), vertex_.z());
+      }
+    }
+    return;
   }
 
   void snemo_foil_vertex_distribution_module::dump_result(std::ostream      & out_,
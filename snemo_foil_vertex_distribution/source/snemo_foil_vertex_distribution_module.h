@@ -39,8 +39,18 @@
 #include <string>
 #include <vector>
 
+// Third party:
+// - Bayeux/geomtools:
+#include <geomtools/clhep.h>
+
+// This project:
+#include <sparse_vertex_map.h>
+#include <foil_strip_table.h>
+
 namespace mygsl {
   class histogram_pool;
+  class histogram_1d;
+  class histogram_2d;
 }
 
 namespace analysis {
@@ -49,6 +59,17 @@ namespace analysis {
   {
   public:
 
+    /// Selection of reconstructed foil vertices
+    enum vertex_mode_type {
+      VERTEX_MODE_INVALID  = -1,
+      VERTEX_MODE_LAST     = 0, //!< Only the last foil vertex
+      VERTEX_MODE_ALL      = 1, //!< Every foil vertex
+      VERTEX_MODE_COMBINED = 2  //!< Barycenter of the event foil vertices
+    };
+
+    /// Convert a vertex mode label into its value
+    static vertex_mode_type get_vertex_mode(const std::string & label_);
+
     /// Setting histogram pool
     void set_histogram_pool(mygsl::histogram_pool & pool_);
 
@@ -83,14 +104,77 @@ namespace analysis {
     /// Give default values to specific class members.
     void _set_defaults();
 
+    /// Return the true vertex (0 if not set)
+    static const geomtools::vector_3d * _get_true_vertex_(const datatools::things & data_,
+                                                         const std::string & bank_label_);
+
+    /// Select the reconstructed foil vertices and return the event multiplicity
+    size_t _select_reconstructed_vertices_(const datatools::things & data_,
+                                           const std::string & bank_label_);
+
+    /// Grab a 1D histogram, building it from a template if needed
+    mygsl::histogram_1d & _grab_histogram_1d_(const std::string & key_,
+                                              const std::string & template_);
+
+    /// Grab a 2D histogram, building it from a template if needed
+    mygsl::histogram_2d & _grab_histogram_2d_(const std::string & key_,
+                                              const std::string & template_);
+
+    /// Fill the vertex distribution, the sparse map and the per strip distributions
+    void _fill_vertex_(mygsl::histogram_2d & histo_, const geomtools::vector_3d & vertex_);
+
   private:
 
     // The label/name of the bank accessible from the event record :
     std::string _bank_label_;
 
+    // The selection of reconstructed foil vertices :
+    vertex_mode_type _vertex_mode_;
+
+    // The reconstructed foil vertices selected in the current event :
+    std::vector<geomtools::vector_3d> _selected_vertices_;
+
+    // The vertex distribution of the single bank mode :
+    mygsl::histogram_2d * _vertex_histogram_;
+
+    // The number of reconstructed foil vertices per event :
+    mygsl::histogram_1d * _multiplicity_histogram_;
+
+    // Flag to read simulated and reconstructed banks in the same pass :
+    bool _paired_mode_;
+
+    // The true, reconstructed and residual distributions of the paired mode :
+    mygsl::histogram_2d * _truth_histogram_;
+    mygsl::histogram_2d * _reco_histogram_;
+    mygsl::histogram_2d * _residual_histogram_;
+
     // The histogram pool :
     mygsl::histogram_pool * _histogram_pool_;
 
+    // Flag to fill the high resolution sparse map :
+    bool _use_sparse_map_;
+
+    // The high resolution sparse map :
+    sparse_vertex_map _sparse_map_;
+
+    // The output file of the sparse map :
+    std::string _sparse_map_filename_;
+
+    // The 2D histogram templates where to export the sparse map :
+    std::vector<std::string> _sparse_map_exports_;
+
+    // Flag to fill per strip distributions :
+    bool _per_strip_;
+
+    // The source strip boundaries :
+    foil_strip_table _strips_;
+
+    // The per strip vertex distributions in strip local coordinates :
+    std::vector<mygsl::histogram_2d *> _strip_histograms_;
+
+    // The number of vertices per strip :
+    mygsl::histogram_1d * _strip_counts_;
+
     // Macro to automate the registration of the module :
     DPP_MODULE_REGISTRATION_INTERFACE(snemo_foil_vertex_distribution_module);
   };
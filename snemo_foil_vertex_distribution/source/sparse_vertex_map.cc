@@ -0,0 +1,177 @@
+/// sparse_vertex_map.cc
+
+// Ourselves:
+#include <sparse_vertex_map.h>
+
+// Standard library:
+#include <stdexcept>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <cmath>
+
+// Third party:
+// - Bayeux/datatools:
+#include <datatools/exception.h>
+// - Bayeux/mygsl
+#include <mygsl/histogram_2d.h>
+
+namespace analysis {
+
+  namespace {
+    /// File header
+    const std::string HEADER = "#@sparse_vertex_map";
+  }
+
+  sparse_vertex_map::sparse_vertex_map(const double cell_size_)
+  {
+    _sum_ = 0.0;
+    set_cell_size(cell_size_);
+    return;
+  }
+
+  double sparse_vertex_map::get_cell_size() const
+  {
+    return _cell_size_;
+  }
+
+  void sparse_vertex_map::set_cell_size(const double cell_size_)
+  {
+    DT_THROW_IF(! _cells_.empty(), std::logic_error, "Cell size of a non-empty map cannot be changed !");
+    DT_THROW_IF(! (cell_size_ > 0.0), std::logic_error, "Cell size must be positive !");
+    _cell_size_ = cell_size_;
+    return;
+  }
+
+  bool sparse_vertex_map::has_cell(const double x_, const double y_) const
+  {
+    // Also false for NaN
+    const double ix = std::floor(x_ / _cell_size_);
+    const double iy = std::floor(y_ / _cell_size_);
+    const double imin = std::numeric_limits<int32_t>::min();
+    const double imax = std::numeric_limits<int32_t>::max();
+    return ix >= imin && ix <= imax && iy >= imin && iy <= imax;
+  }
+
+  uint64_t sparse_vertex_map::make_key(const double x_, const double y_) const
+  {
+    DT_THROW_IF(! has_cell(x_, y_), std::domain_error,
+                "Position (" << x_ << ", " << y_ << ") has no cell !");
+    const int32_t ix = static_cast<int32_t>(std::floor(x_ / _cell_size_));
+    const int32_t iy = static_cast<int32_t>(std::floor(y_ / _cell_size_));
+    return (static_cast<uint64_t>(static_cast<uint32_t>(ix)) << 32) | static_cast<uint32_t>(iy);
+  }
+
+  void sparse_vertex_map::get_cell_center(const uint64_t key_, double & x_, double & y_) const
+  {
+    const int32_t ix = static_cast<int32_t>(static_cast<uint32_t>(key_ >> 32));
+    const int32_t iy = static_cast<int32_t>(static_cast<uint32_t>(key_ & 0xFFFFFFFF));
+    x_ = (ix + 0.5) * _cell_size_;
+    y_ = (iy + 0.5) * _cell_size_;
+    return;
+  }
+
+  void sparse_vertex_map::fill(const double x_, const double y_, const double weight_)
+  {
+    if (! has_cell(x_, y_)) return;
+    _cells_[make_key(x_, y_)] += weight_;
+    _sum_ += weight_;
+    return;
+  }
+
+  size_t sparse_vertex_map::get_number_of_cells() const
+  {
+    return _cells_.size();
+  }
+
+  double sparse_vertex_map::get_sum() const
+  {
+    return _sum_;
+  }
+
+  double sparse_vertex_map::get_value(const double x_, const double y_) const
+  {
+    if (! has_cell(x_, y_)) return 0.0;
+    const cell_dict_type::const_iterator found = _cells_.find(make_key(x_, y_));
+    return found != _cells_.end() ? found->second : 0.0;
+  }
+
+  const sparse_vertex_map::cell_dict_type & sparse_vertex_map::get_cells() const
+  {
+    return _cells_;
+  }
+
+  void sparse_vertex_map::merge(const sparse_vertex_map & other_)
+  {
+    DT_THROW_IF(other_._cell_size_ != _cell_size_, std::logic_error,
+                "Maps with different cell sizes cannot be merged !");
+    for (const auto & a_cell : other_._cells_) {
+      _cells_[a_cell.first] += a_cell.second;
+    }
+    _sum_ += other_._sum_;
+    return;
+  }
+
+  void sparse_vertex_map::export_histogram(mygsl::histogram_2d & histo_) const
+  {
+    double x, y;
+    for (const auto & a_cell : _cells_) {
+      get_cell_center(a_cell.first, x, y);
+      histo_.fill(x, y, a_cell.second);
+    }
+    return;
+  }
+
+  void sparse_vertex_map::clear()
+  {
+    _cells_.clear();
+    _sum_ = 0.0;
+    return;
+  }
+
+  void sparse_vertex_map::store(const std::string & filename_) const
+  {
+    std::ofstream fout(filename_.c_str());
+    DT_THROW_IF(! fout, std::runtime_error, "Cannot open file '" << filename_ << "' !");
+    fout << std::setprecision(std::numeric_limits<double>::digits10 + 2);
+    fout << HEADER << ' ' << _cell_size_ << ' ' << _cells_.size() << std::endl;
+    for (const auto & a_cell : _cells_) {
+      fout << a_cell.first << ' ' << a_cell.second << std::endl;
+    }
+    DT_THROW_IF(! fout, std::runtime_error, "Writing into file '" << filename_ << "' fails !");
+    return;
+  }
+
+  void sparse_vertex_map::load(const std::string & filename_)
+  {
+    std::ifstream fin(filename_.c_str());
+    DT_THROW_IF(! fin, std::runtime_error, "Cannot open file '" << filename_ << "' !");
+    std::string header;
+    double cell_size = 0.0;
+    size_t ncells = 0;
+    fin >> header >> cell_size >> ncells;
+    DT_THROW_IF(! fin || header != HEADER, std::runtime_error,
+                "File '" << filename_ << "' is not a sparse vertex map !");
+    DT_THROW_IF(cell_size != _cell_size_, std::logic_error,
+                "Map stored in '" << filename_ << "' has a different cell size !");
+    for (size_t i = 0; i < ncells; i++) {
+      uint64_t key;
+      double value;
+      fin >> key >> value;
+      DT_THROW_IF(! fin, std::runtime_error, "File '" << filename_ << "' is truncated !");
+      _cells_[key] += value;
+      _sum_ += value;
+    }
+    return;
+  }
+
+} // namespace analysis
+
+// end of sparse_vertex_map.cc
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
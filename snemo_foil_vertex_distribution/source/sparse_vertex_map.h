@@ -0,0 +1,122 @@
+/// \file sparse_vertex_map.h
+/* Author(s)     : Xavier Garrido <garrido@lal.in2p3.fr>
+ * Creation date : 2026-10-18
+ * Last modified : 2026-10-18
+ *
+ * Copyright (C) 2026 Xavier Garrido <garrido@lal.in2p3.fr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * Description:
+ *
+ *   Sparse 2D map of vertices. Only the cells of a fine regular grid that
+ *   received at least one vertex are stored, so that sub-millimetre cells
+ *   can be used over the whole source foil. The map can be exported into a
+ *   histogram of any binning and maps from several jobs can be merged.
+ *
+ * History:
+ *
+ */
+
+#ifndef ANALYSIS_SPARSE_VERTEX_MAP_H
+#define ANALYSIS_SPARSE_VERTEX_MAP_H 1
+
+// Standard library:
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+
+namespace mygsl {
+  class histogram_2d;
+}
+
+namespace analysis {
+
+  /// \brief Sparse 2D vertex map
+  class sparse_vertex_map
+  {
+  public:
+
+    /// Typedef for cell dictionary
+    typedef std::unordered_map<uint64_t, double> cell_dict_type;
+
+    /// Default constructor
+    sparse_vertex_map(const double cell_size_ = 1.0);
+
+    /// Return the cell size
+    double get_cell_size() const;
+
+    /// Set the cell size (the map must be empty)
+    void set_cell_size(const double cell_size_);
+
+    /// Fill the map (positions without cell are ignored)
+    void fill(const double x_, const double y_, const double weight_ = 1.0);
+
+    /// Return the number of non-empty cells
+    size_t get_number_of_cells() const;
+
+    /// Return the sum of weights
+    double get_sum() const;
+
+    /// Return the content of the cell holding a given position (0 if none)
+    double get_value(const double x_, const double y_) const;
+
+    /// Return the non-empty cells
+    const cell_dict_type & get_cells() const;
+
+    /// Add the content of another map with the same cell size
+    void merge(const sparse_vertex_map & other_);
+
+    /// Fill a histogram with the content of the cells (at cell center)
+    void export_histogram(mygsl::histogram_2d & histo_) const;
+
+    /// Remove all cells
+    void clear();
+
+    /// Save the map into a file
+    void store(const std::string & filename_) const;
+
+    /// Add the content of a file to the map
+    void load(const std::string & filename_);
+
+    /// Check if a position has a cell (finite and within the 32 bits cell index range)
+    bool has_cell(const double x_, const double y_) const;
+
+    /// Build the cell key of a given position (which must have a cell)
+    uint64_t make_key(const double x_, const double y_) const;
+
+    /// Return the center of the cell with a given key
+    void get_cell_center(const uint64_t key_, double & x_, double & y_) const;
+
+  private:
+
+    double         _cell_size_; //!< Size of a cell
+    double         _sum_;       //!< Sum of weights
+    cell_dict_type _cells_;     //!< Non-empty cells
+
+  };
+
+} // namespace analysis
+
+#endif // ANALYSIS_SPARSE_VERTEX_MAP_H
+
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
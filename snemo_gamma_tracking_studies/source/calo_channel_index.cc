@@ -0,0 +1,98 @@
+/// calo_channel_index.cc
+
+// Ourselves:
+#include <calo_channel_index.h>
+
+// Standard library:
+#include <stdexcept>
+
+// Third party:
+// - Bayeux/datatools:
+#include <datatools/exception.h>
+
+namespace analysis {
+
+  uint64_t calo_channel_index::make_key(const geomtools::geom_id & gid_)
+  {
+    // The type is stored in the upper 16 bits and each address item in 8 bits
+    const size_t depth = gid_.get_depth();
+    DT_THROW_IF(gid_.get_type() > 0xFFFF || depth > 6, std::logic_error,
+                "Calorimeter geom_id '" << gid_ << "' can not be packed !");
+    uint64_t key = static_cast<uint64_t>(gid_.get_type()) << 48;
+    for (size_t i = 0; i < depth; i++) {
+      const uint32_t item = gid_.get(i);
+      uint64_t code = item;
+      if (item == geomtools::geom_id::ANY_ADDRESS) {
+        code = 0xFE;
+      } else if (item == geomtools::geom_id::INVALID_ADDRESS) {
+        code = 0xFF;
+      } else {
+        DT_THROW_IF(item >= 0xFE, std::logic_error,
+                    "Calorimeter geom_id '" << gid_ << "' can not be packed !");
+      }
+      key |= code << (8 * (5 - i));
+    }
+    return key;
+  }
+
+  uint32_t calo_channel_index::get_channel(const geomtools::geom_id & gid_)
+  {
+    const std::pair<std::unordered_map<uint64_t, uint32_t>::iterator, bool> inserted
+      = _channels_.insert(std::make_pair(make_key(gid_), (uint32_t)_gids_.size()));
+    if (inserted.second) _gids_.push_back(gid_);
+    return inserted.first->second;
+  }
+
+  const geomtools::geom_id & calo_channel_index::get_geom_id(const uint32_t channel_) const
+  {
+    return _gids_.at(channel_);
+  }
+
+  size_t calo_channel_index::size() const
+  {
+    return _gids_.size();
+  }
+
+  void calo_channel_index::clear()
+  {
+    _channels_.clear();
+    _gids_.clear();
+    return;
+  }
+
+  void calo_channel_set::insert(const uint32_t channel_)
+  {
+    const size_t iword = channel_ / 64;
+    if (iword >= _words_.size()) _words_.resize(iword + 1, 0);
+    const uint64_t mask = uint64_t(1) << (channel_ % 64);
+    if (_words_[iword] & mask) return;
+    _words_[iword] |= mask;
+    _channels_.push_back(channel_);
+    return;
+  }
+
+  bool calo_channel_set::contains(const uint32_t channel_) const
+  {
+    const size_t iword = channel_ / 64;
+    return iword < _words_.size() && (_words_[iword] >> (channel_ % 64)) & 1;
+  }
+
+  void calo_channel_set::clear()
+  {
+    for (size_t i = 0; i < _channels_.size(); i++) {
+      _words_[_channels_[i] / 64] = 0;
+    }
+    _channels_.clear();
+    return;
+  }
+
+} // namespace analysis
+
+// end of calo_channel_index.cc
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
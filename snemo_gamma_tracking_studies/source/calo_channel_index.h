@@ -0,0 +1,105 @@
+/// \file calo_channel_index.h
+/* Author(s)     : Xavier Garrido <garrido@lal.in2p3.fr>
+ * Creation date : 2026-10-18
+ * Last modified : 2026-10-18
+ *
+ * Copyright (C) 2026 Xavier Garrido <garrido@lal.in2p3.fr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * Description:
+ *
+ *   Dense numbering of calorimeter channels. Each calorimeter geom_id gets a
+ *   small integer id the first time it is seen, so that calorimeter sequences
+ *   can be stored as sorted integer arrays and channel sets as bitsets.
+ *
+ * History:
+ *
+ */
+
+#ifndef ANALYSIS_CALO_CHANNEL_INDEX_H
+#define ANALYSIS_CALO_CHANNEL_INDEX_H 1
+
+// Standard library:
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+// Third party:
+// - Bayeux/geomtools:
+#include <geomtools/geom_id.h>
+
+namespace analysis {
+
+  /// \brief Dense numbering of calorimeter channels
+  class calo_channel_index
+  {
+  public:
+
+    /// Return the channel id of a calorimeter, registering it if needed
+    uint32_t get_channel(const geomtools::geom_id & gid_);
+
+    /// Return the geom_id of a channel
+    const geomtools::geom_id & get_geom_id(const uint32_t channel_) const;
+
+    /// Return the number of registered channels
+    size_t size() const;
+
+    /// Remove all channels
+    void clear();
+
+    /// Pack a geom_id into a 64 bits key
+    static uint64_t make_key(const geomtools::geom_id & gid_);
+
+  private:
+
+    std::unordered_map<uint64_t, uint32_t> _channels_; //!< Channel ids by key
+    std::vector<geomtools::geom_id>        _gids_;     //!< Geom ids by channel
+
+  };
+
+  /// \brief Set of channels stored as a bitset
+  class calo_channel_set
+  {
+  public:
+
+    /// Add a channel
+    void insert(const uint32_t channel_);
+
+    /// Check if a channel belongs to the set
+    bool contains(const uint32_t channel_) const;
+
+    /// Remove all channels (only the words in use are reset)
+    void clear();
+
+  private:
+
+    std::vector<uint64_t> _words_;    //!< Bit words
+    std::vector<uint32_t> _channels_; //!< Channels in the set
+
+  };
+
+} // namespace analysis
+
+#endif // ANALYSIS_CALO_CHANNEL_INDEX_H
+
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
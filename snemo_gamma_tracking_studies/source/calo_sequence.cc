@@ -0,0 +1,53 @@
+/// calo_sequence.cc
+
+// Ourselves:
+#include <calo_sequence.h>
+
+// Standard library:
+#include <algorithm>
+
+namespace analysis {
+
+  size_t calo_sequence::size() const
+  {
+    return nchannels;
+  }
+
+  uint32_t calo_sequence::front() const
+  {
+    return ordered[0];
+  }
+
+  bool calo_sequence::is_same(const calo_sequence & other_) const
+  {
+    return hash == other_.hash && nchannels == other_.nchannels
+      && std::equal(channels, channels + nchannels, other_.channels);
+  }
+
+  bool calo_sequence::is_same_order(const calo_sequence & other_) const
+  {
+    return nchannels == other_.nchannels
+      && std::equal(ordered, ordered + nchannels, other_.ordered);
+  }
+
+  uint64_t calo_sequence::compute_hash(const uint32_t * channels_, const size_t nchannels_)
+  {
+    // FNV-1a hash
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < nchannels_; i++) {
+      hash ^= channels_[i];
+      hash *= 1099511628211ULL;
+    }
+    return hash;
+  }
+
+} // namespace analysis
+
+// end of calo_sequence.cc
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
@@ -0,0 +1,78 @@
+/// \file calo_sequence.h
+/* Author(s)     : Xavier Garrido <garrido@lal.in2p3.fr>
+ * Creation date : 2026-10-18
+ * Last modified : 2026-10-18
+ *
+ * Copyright (C) 2026 Xavier Garrido <garrido@lal.in2p3.fr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * Description:
+ *
+ *   Canonical representation of the calorimeters hit by a gamma: sorted
+ *   channel ids together with their hash so that two sequences are compared
+ *   by their hash first. The time ordered sequence of channels is also kept
+ *   for order aware comparisons. A sequence is a view on the arrays owned by
+ *   a gamma dictionary.
+ *
+ * History:
+ *
+ */
+
+#ifndef ANALYSIS_CALO_SEQUENCE_H
+#define ANALYSIS_CALO_SEQUENCE_H 1
+
+// Standard library:
+#include <cstddef>
+#include <cstdint>
+
+namespace analysis {
+
+  /// \brief Canonical calorimeter sequence
+  struct calo_sequence
+  {
+    /// Return the number of channels
+    size_t size() const;
+
+    /// Return the earliest channel
+    uint32_t front() const;
+
+    /// Check if two sequences hold the same channels
+    bool is_same(const calo_sequence & other_) const;
+
+    /// Check if two sequences hold the same channels in the same time order
+    bool is_same_order(const calo_sequence & other_) const;
+
+    /// Compute the hash of sorted channel ids
+    static uint64_t compute_hash(const uint32_t * channels_, const size_t nchannels_);
+
+    const uint32_t * channels;  //!< Sorted channel ids
+    const uint32_t * ordered;   //!< Channel ids ordered by time
+    size_t           nchannels; //!< Number of channels
+    uint64_t         hash;      //!< Hash of the channel ids
+  };
+
+} // namespace analysis
+
+#endif // ANALYSIS_CALO_SEQUENCE_H
+
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
@@ -0,0 +1,114 @@
+/// gamma_dict.cc
+
+// Ourselves:
+#include <gamma_dict.h>
+
+// Standard library:
+#include <algorithm>
+
+namespace analysis {
+
+  void gamma_dict::clear()
+  {
+    _hits_.clear();
+    _gammas_.clear();
+    _channels_.clear();
+    _ordered_.clear();
+    _by_hash_.clear();
+    return;
+  }
+
+  void gamma_dict::add(const int track_id_, const uint32_t channel_, const double time_)
+  {
+    const hit_type a_hit = { track_id_, channel_, time_ };
+    _hits_.push_back(a_hit);
+    return;
+  }
+
+  void gamma_dict::finalize()
+  {
+    _gammas_.clear();
+    _channels_.clear();
+    _ordered_.clear();
+    _by_hash_.clear();
+    std::sort(_hits_.begin(), _hits_.end(), [] (const hit_type & a_, const hit_type & b_) {
+        if (a_.track_id != b_.track_id) return a_.track_id < b_.track_id;
+        if (a_.time != b_.time) return a_.time < b_.time;
+        return a_.channel < b_.channel;
+      });
+
+    for (size_t i = 0; i < _hits_.size(); i++) {
+      if (_gammas_.empty() || _gammas_.back().track_id != _hits_[i].track_id) {
+        const gamma_type a_gamma = { _hits_[i].track_id, _ordered_.size(), _ordered_.size(), 0 };
+        _gammas_.push_back(a_gamma);
+      }
+      // Each channel is kept at its earliest time
+      gamma_type & a_gamma = _gammas_.back();
+      const std::vector<uint32_t>::const_iterator first = _ordered_.begin() + a_gamma.begin;
+      if (std::find(first, _ordered_.cend(), _hits_[i].channel) != _ordered_.cend()) continue;
+      _ordered_.push_back(_hits_[i].channel);
+      a_gamma.end++;
+    }
+
+    _channels_ = _ordered_;
+    for (size_t i = 0; i < _gammas_.size(); i++) {
+      gamma_type & a_gamma = _gammas_[i];
+      std::sort(_channels_.begin() + a_gamma.begin, _channels_.begin() + a_gamma.end);
+      a_gamma.hash = calo_sequence::compute_hash(_channels_.data() + a_gamma.begin, a_gamma.end - a_gamma.begin);
+      _by_hash_.push_back(i);
+    }
+    std::sort(_by_hash_.begin(), _by_hash_.end(), [this] (const size_t a_, const size_t b_) {
+        return _gammas_[a_].hash < _gammas_[b_].hash;
+      });
+    return;
+  }
+
+  size_t gamma_dict::size() const
+  {
+    return _gammas_.size();
+  }
+
+  bool gamma_dict::empty() const
+  {
+    return _gammas_.empty();
+  }
+
+  int gamma_dict::get_track_id(const size_t gamma_) const
+  {
+    return _gammas_.at(gamma_).track_id;
+  }
+
+  calo_sequence gamma_dict::get_sequence(const size_t gamma_) const
+  {
+    const gamma_type & a_gamma = _gammas_.at(gamma_);
+    calo_sequence a_sequence;
+    a_sequence.channels  = _channels_.data() + a_gamma.begin;
+    a_sequence.ordered   = _ordered_.data() + a_gamma.begin;
+    a_sequence.nchannels = a_gamma.end - a_gamma.begin;
+    a_sequence.hash      = a_gamma.hash;
+    return a_sequence;
+  }
+
+  int gamma_dict::find_same(const calo_sequence & sequence_) const
+  {
+    std::vector<size_t>::const_iterator it
+      = std::lower_bound(_by_hash_.begin(), _by_hash_.end(), sequence_.hash,
+                         [this] (const size_t a_, const uint64_t hash_) {
+                           return _gammas_[a_].hash < hash_;
+                         });
+    for (; it != _by_hash_.end() && _gammas_[*it].hash == sequence_.hash; ++it) {
+      if (get_sequence(*it).is_same(sequence_)) return *it;
+    }
+    return -1;
+  }
+
+} // namespace analysis
+
+// end of gamma_dict.cc
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
@@ -0,0 +1,113 @@
+/// \file gamma_dict.h
+/* Author(s)     : Xavier Garrido <garrido@lal.in2p3.fr>
+ * Creation date : 2026-10-18
+ * Last modified : 2026-10-18
+ *
+ * Copyright (C) 2026 Xavier Garrido <garrido@lal.in2p3.fr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * Description:
+ *
+ *   Flat dictionary of the calorimeter sequences of gammas. Calorimeter hits
+ *   are collected into an arena, then sorted by gamma and time to build the
+ *   sequences as slices of contiguous arrays. Clearing the dictionary keeps
+ *   the memory so that a dictionary reused from event to event does not
+ *   allocate once the largest event has been seen.
+ *
+ * History:
+ *
+ */
+
+#ifndef ANALYSIS_GAMMA_DICT_H
+#define ANALYSIS_GAMMA_DICT_H 1
+
+// Standard library:
+#include <vector>
+#include <cstdint>
+
+// This project:
+#include <calo_sequence.h>
+
+namespace analysis {
+
+  /// \brief Flat dictionary of gamma calorimeter sequences
+  class gamma_dict
+  {
+  public:
+
+    /// Remove all gammas (memory is kept)
+    void clear();
+
+    /// Add a calorimeter hit of a gamma
+    void add(const int track_id_, const uint32_t channel_, const double time_);
+
+    /// Build the calorimeter sequences of gammas
+    void finalize();
+
+    /// Return the number of gammas
+    size_t size() const;
+
+    /// Check if the dictionary is empty
+    bool empty() const;
+
+    /// Return the track id of a gamma
+    int get_track_id(const size_t gamma_) const;
+
+    /// Return the calorimeter sequence of a gamma
+    calo_sequence get_sequence(const size_t gamma_) const;
+
+    /// Return the index of a gamma with the same channels (-1 if none)
+    int find_same(const calo_sequence & sequence_) const;
+
+  private:
+
+    /// Calorimeter hit
+    struct hit_type
+    {
+      int      track_id;
+      uint32_t channel;
+      double   time;
+    };
+
+    /// Gamma entry
+    struct gamma_type
+    {
+      int      track_id;
+      size_t   begin;
+      size_t   end;
+      uint64_t hash;
+    };
+
+    std::vector<hit_type>   _hits_;     //!< Arena of calorimeter hits
+    std::vector<gamma_type> _gammas_;   //!< Gammas sorted by track id
+    std::vector<uint32_t>   _channels_; //!< Sorted channels of all gammas
+    std::vector<uint32_t>   _ordered_;  //!< Time ordered channels of all gammas
+    std::vector<size_t>     _by_hash_;  //!< Gamma indices sorted by hash
+
+  };
+
+} // namespace analysis
+
+#endif // ANALYSIS_GAMMA_DICT_H
+
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
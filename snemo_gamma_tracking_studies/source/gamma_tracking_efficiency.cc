@@ -0,0 +1,149 @@
+/// gamma_tracking_efficiency.cc
+
+// Ourselves:
+#include <gamma_tracking_efficiency.h>
+
+// Standard library:
+#include <stdexcept>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+
+// Third party:
+// - Bayeux/datatools:
+#include <datatools/exception.h>
+
+namespace analysis {
+
+  namespace {
+    /// File header
+    const std::string HEADER = "#@gamma_tracking_efficiency";
+
+    /// Return a ratio in percent
+    double percent(const double n_, const double d_)
+    {
+      return d_ > 0 ? n_ / d_ * 100 : 0.0;
+    }
+  }
+
+  const size_t gamma_tracking_efficiency::MAX_MULTIPLICITY;
+
+  gamma_tracking_efficiency::gamma_tracking_efficiency()
+  {
+    reset();
+    return;
+  }
+
+  void gamma_tracking_efficiency::reset()
+  {
+    nevent      = 0;
+    ntotal      = 0;
+    ngood       = 0;
+    nmiss       = 0;
+    nmatched    = 0;
+    nordered    = 0;
+    nfirst      = 0;
+    sum_jaccard = 0.0;
+    for (size_t i = 0; i <= MAX_MULTIPLICITY; i++) {
+      for (size_t j = 0; j <= MAX_MULTIPLICITY; j++) {
+        confusion[i][j] = 0;
+      }
+    }
+    return;
+  }
+
+  void gamma_tracking_efficiency::merge(const gamma_tracking_efficiency & other_)
+  {
+    nevent      += other_.nevent;
+    ntotal      += other_.ntotal;
+    ngood       += other_.ngood;
+    nmiss       += other_.nmiss;
+    nmatched    += other_.nmatched;
+    nordered    += other_.nordered;
+    nfirst      += other_.nfirst;
+    sum_jaccard += other_.sum_jaccard;
+    for (size_t i = 0; i <= MAX_MULTIPLICITY; i++) {
+      for (size_t j = 0; j <= MAX_MULTIPLICITY; j++) {
+        confusion[i][j] += other_.confusion[i][j];
+      }
+    }
+    return;
+  }
+
+  void gamma_tracking_efficiency::print(std::ostream & out_, const std::string & indent_) const
+  {
+    out_ << indent_ << "Number of gammas well reconstructed = " << ngood << "/" << ntotal
+         << " (" << percent(ngood, ntotal) << "%)" << std::endl;
+    out_ << indent_ << "Number of gammas missed = " << nmiss << "/" << nevent
+         << " (" << percent(nmiss, nevent) << "%)" << std::endl;
+    out_ << indent_ << "Number of gammas with time ordered sequence = " << nordered << "/" << ntotal
+         << " (" << percent(nordered, ntotal) << "%)" << std::endl;
+    out_ << indent_ << "Number of gammas with right first calorimeter = " << nfirst << "/" << ntotal
+         << " (" << percent(nfirst, ntotal) << "%)" << std::endl;
+    out_ << indent_ << "Number of gammas partially reconstructed = " << nmatched << "/" << ntotal
+         << " (" << percent(nmatched, ntotal) << "%)" << std::endl;
+    out_ << indent_ << "Mean Jaccard index = " << (ntotal > 0 ? sum_jaccard / ntotal : 0.0) << std::endl;
+    out_ << indent_ << "Events by simulated (rows) vs. reconstructed (columns) gamma multiplicities:"
+         << std::endl;
+    for (size_t i = 0; i <= MAX_MULTIPLICITY; i++) {
+      out_ << indent_ << std::setw(2) << i << (i == MAX_MULTIPLICITY ? "+" : " ");
+      for (size_t j = 0; j <= MAX_MULTIPLICITY; j++) {
+        out_ << ' ' << std::setw(8) << confusion[i][j];
+      }
+      out_ << std::endl;
+    }
+    return;
+  }
+
+  void gamma_tracking_efficiency::store(const std::string & filename_) const
+  {
+    std::ofstream fout(filename_.c_str());
+    DT_THROW_IF(! fout, std::runtime_error, "Cannot open file '" << filename_ << "' !");
+    fout << std::setprecision(std::numeric_limits<double>::digits10 + 2);
+    fout << HEADER << ' ' << MAX_MULTIPLICITY << std::endl;
+    fout << nevent << ' ' << ntotal << ' ' << ngood << ' ' << nmiss << ' '
+         << nmatched << ' ' << nordered << ' ' << nfirst << ' ' << sum_jaccard << std::endl;
+    for (size_t i = 0; i <= MAX_MULTIPLICITY; i++) {
+      for (size_t j = 0; j <= MAX_MULTIPLICITY; j++) {
+        fout << (j > 0 ? " " : "") << confusion[i][j];
+      }
+      fout << std::endl;
+    }
+    DT_THROW_IF(! fout, std::runtime_error, "Writing into file '" << filename_ << "' fails !");
+    return;
+  }
+
+  void gamma_tracking_efficiency::load(const std::string & filename_)
+  {
+    std::ifstream fin(filename_.c_str());
+    DT_THROW_IF(! fin, std::runtime_error, "Cannot open file '" << filename_ << "' !");
+    std::string header;
+    size_t max_multiplicity = 0;
+    fin >> header >> max_multiplicity;
+    DT_THROW_IF(! fin || header != HEADER, std::runtime_error,
+                "File '" << filename_ << "' is not a gamma tracking efficiency record !");
+    DT_THROW_IF(max_multiplicity != MAX_MULTIPLICITY, std::logic_error,
+                "Record stored in '" << filename_ << "' has a different multiplicity range !");
+    gamma_tracking_efficiency other;
+    fin >> other.nevent >> other.ntotal >> other.ngood >> other.nmiss
+        >> other.nmatched >> other.nordered >> other.nfirst >> other.sum_jaccard;
+    for (size_t i = 0; i <= MAX_MULTIPLICITY; i++) {
+      for (size_t j = 0; j <= MAX_MULTIPLICITY; j++) {
+        fin >> other.confusion[i][j];
+      }
+    }
+    DT_THROW_IF(! fin, std::runtime_error, "File '" << filename_ << "' is truncated !");
+    merge(other);
+    return;
+  }
+
+} // namespace analysis
+
+// end of gamma_tracking_efficiency.cc
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
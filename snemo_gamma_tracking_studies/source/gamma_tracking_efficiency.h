@@ -0,0 +1,87 @@
+/// \file gamma_tracking_efficiency.h
+/* Author(s)     : Xavier Garrido <garrido@lal.in2p3.fr>
+ * Creation date : 2026-10-18
+ * Last modified : 2026-10-18
+ *
+ * Copyright (C) 2026 Xavier Garrido <garrido@lal.in2p3.fr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * Description:
+ *
+ *   Counters of the gamma tracking efficiency. Records from several jobs
+ *   can be merged together or through files.
+ *
+ * History:
+ *
+ */
+
+#ifndef ANALYSIS_GAMMA_TRACKING_EFFICIENCY_H
+#define ANALYSIS_GAMMA_TRACKING_EFFICIENCY_H 1
+
+// Standard library:
+#include <iostream>
+#include <string>
+
+namespace analysis {
+
+  /// \brief Gamma tracking efficiency record
+  struct gamma_tracking_efficiency
+  {
+    /// Gamma multiplicity above which gammas are counted together
+    static const size_t MAX_MULTIPLICITY = 5;
+
+    /// Default constructor
+    gamma_tracking_efficiency();
+
+    /// Reset all counters
+    void reset();
+
+    /// Add the counters of another record
+    void merge(const gamma_tracking_efficiency & other_);
+
+    /// Print the efficiencies
+    void print(std::ostream & out_ = std::clog, const std::string & indent_ = "") const;
+
+    /// Save the record into a file
+    void store(const std::string & filename_) const;
+
+    /// Add the content of a file to the record
+    void load(const std::string & filename_);
+
+    size_t nevent;      //!< Total number of event processed
+    size_t ntotal;      //!< Total number of gammas simulated
+    size_t ngood;       //!< Number of gammas well reconstructed
+    size_t nmiss;       //!< Number of gammas that do not trigger detector
+    size_t nmatched;    //!< Number of simulated gammas sharing calorimeters with a reconstructed gamma
+    size_t nordered;    //!< Number of simulated gammas reconstructed with the same time ordered sequence
+    size_t nfirst;      //!< Number of simulated gammas whose first calorimeter is well reconstructed
+    double sum_jaccard; //!< Sum of the best Jaccard index of simulated gammas
+    /// Number of events by simulated (row) and reconstructed (column) gamma multiplicities
+    size_t confusion[MAX_MULTIPLICITY + 1][MAX_MULTIPLICITY + 1];
+  };
+
+} // namespace analysis
+
+#endif // ANALYSIS_GAMMA_TRACKING_EFFICIENCY_H
+
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
@@ -7,8 +7,12 @@
 #include <stdexcept>
 #include <sstream>
 #include <algorithm>
+#include <utility>
+#include <vector>
 
 // Third party:
+// - Bayeux/datatools:
+#include <datatools/utils.h>
 // - Bayeux/mctools
 #include <mctools/utils.h>
 #include <mctools/simulated_data.h>
@@ -18,6 +22,9 @@
 #include <snemo/datamodels/calibrated_data.h>
 #include <snemo/datamodels/particle_track_data.h>
 
+// - Shared event view
+#include <event_view_service.h>
+
 namespace analysis {
 
   // Registration instantiation macro :
@@ -26,13 +33,25 @@ namespace analysis {
 
   void snemo_gamma_tracking_studies_module::_set_defaults()
   {
-    _efficiency_ = {0, 0, 0, 0};
+    _efficiency_.reset();
+    _efficiency_filename_.clear();
+    _channels_.clear();
+    _calibrated_channels_.clear();
+    _channel_owners_.clear();
+    _overlaps_.clear();
+    _simulated_gammas_.clear();
+    _reconstructed_gammas_.clear();
+    _view_ = 0;
+    _shared_view_ = 0;
+    _shared_view_serial_ = 0;
+    _shared_view_checked_ = false;
+    _local_view_.clear();
     return;
   }
 
   // Initialization :
   void snemo_gamma_tracking_studies_module::initialize(const datatools::properties  & config_,
-                                                       datatools::service_manager   & /*service_manager_*/,
+                                                       datatools::service_manager   & service_manager_,
                                                        dpp::module_handle_dict_type & /*module_dict_*/)
   {
     DT_THROW_IF(is_initialized(),
@@ -41,6 +60,32 @@ namespace analysis {
 
     dpp::base_module::_common_initialize(config_);
 
+    // Efficiency records from previous jobs
+    if (config_.has_key("efficiency.input_files")) {
+      std::vector<std::string> input_files;
+      config_.fetch("efficiency.input_files", input_files);
+      for (size_t i = 0; i < input_files.size(); i++) {
+        datatools::fetch_path_with_env(input_files[i]);
+        _efficiency_.load(input_files[i]);
+      }
+    }
+    if (config_.has_key("efficiency.output_file")) {
+      _efficiency_filename_ = config_.fetch_string("efficiency.output_file");
+      datatools::fetch_path_with_env(_efficiency_filename_);
+    }
+
+    // Banks and particles may be shared with other modules through the event view
+    if (config_.has_key("EventView_label")) {
+      const std::string view_label = config_.fetch_string("EventView_label");
+      DT_THROW_IF(! service_manager_.has(view_label) ||
+                  ! service_manager_.is_a<snemo::analysis::event_view_service>(view_label),
+                  std::logic_error,
+                  "Module '" << get_name() << "' has no '" << view_label << "' service !");
+      _shared_view_ = &service_manager_.grab<snemo::analysis::event_view_service>(view_label).grab_view();
+      _shared_view_serial_ = _shared_view_->get_serial();
+    }
+    _view_ = &_local_view_;
+
     // Tag the module as initialized :
     _set_initialized(true);
     return;
@@ -53,12 +98,14 @@ namespace analysis {
                 "Module '" << get_name() << "' is not initialized !");
 
     // Present results
-    DT_LOG_NOTICE(get_logging_priority(),
-                  "Number of gammas well reconstructed = " << _efficiency_.ngood << "/" << _efficiency_.ntotal
-                  << " (" << _efficiency_.ngood/(double)_efficiency_.ntotal*100 << "%)");
-    DT_LOG_NOTICE(get_logging_priority(),
-                  "Number of gammas missed = " << _efficiency_.nmiss << "/" << _efficiency_.nevent
-                  << " (" << _efficiency_.nmiss/(double)_efficiency_.nevent*100 << "%)");
+    if (get_logging_priority() >= datatools::logger::PRIO_NOTICE) {
+      std::ostringstream oss;
+      _efficiency_.print(oss);
+      DT_LOG_NOTICE(get_logging_priority(), "Gamma tracking efficiency :" << std::endl << oss.str());
+    }
+    if (! _efficiency_filename_.empty()) {
+      _efficiency_.store(_efficiency_filename_);
+    }
 
     // Tag the module as un-initialized :
     _set_initialized(false);
@@ -88,40 +135,58 @@ namespace analysis {
     DT_THROW_IF(! is_initialized(), std::logic_error,
                 "Module '" << get_name() << "' is not initialized !");
 
-    gamma_dict_type simulated_gammas;
+    // The shared view is only used if the 'event_view_module' has bound it to
+    // a new record since the previous call: the record object being reused by
+    // dpp, its address can not tell a stale view
+    _view_ = &_local_view_;
+    if (_shared_view_ != 0) {
+      const uint64_t a_serial = _shared_view_->get_serial();
+      if (a_serial != _shared_view_serial_) {
+        _shared_view_serial_ = a_serial;
+        _view_ = _shared_view_;
+      } else if (! _shared_view_checked_) {
+        DT_LOG_WARNING(get_logging_priority(), "The 'event_view_module' is missing or not run before module '"
+                       << get_name() << "': the shared event view is not used !");
+        _shared_view_ = 0;
+      } else {
+        DT_LOG_WARNING(get_logging_priority(), "Shared event view is not bound to the current record !");
+      }
+      _shared_view_checked_ = true;
+    }
+    if (_view_ == &_local_view_) _local_view_.reset(data_record_);
+
+    // Dictionaries are reused from one event to the other
+    _simulated_gammas_.clear();
+    _reconstructed_gammas_.clear();
     {
-      const process_status status = _process_simulated_gammas(data_record_, simulated_gammas);
+      const process_status status = _process_simulated_gammas(_simulated_gammas_);
       if (status != dpp::base_module::PROCESS_OK) {
         DT_LOG_ERROR(get_logging_priority(), "Processing of simulated data fails !");
         return status;
       }
     }
-    gamma_dict_type reconstructed_gammas;
     {
-      const process_status status = _process_reconstructed_gammas(data_record_, reconstructed_gammas);
+      const process_status status = _process_reconstructed_gammas(_reconstructed_gammas_);
       if (status != dpp::base_module::PROCESS_OK) {
         DT_LOG_ERROR(get_logging_priority(), "Processing of particle track data fails !");
         return status;
       }
     }
 
-    _compare_sequences(simulated_gammas, reconstructed_gammas);
+    _compare_sequences(_simulated_gammas_, _reconstructed_gammas_);
 
     DT_LOG_TRACE(get_logging_priority(), "Exiting.");
     return dpp::base_module::PROCESS_SUCCESS;
   }
 
-  dpp::base_module::process_status snemo_gamma_tracking_studies_module::_process_simulated_gammas(const datatools::things & data_record_,
-                                                                                                  gamma_dict_type & simulated_gammas_)
+  dpp::base_module::process_status snemo_gamma_tracking_studies_module::_process_simulated_gammas(gamma_dict_type & simulated_gammas_)
   {
-    // Check if some 'simulated_data' are available in the data model:
-    const std::string sd_label = snemo::datamodel::data_info::default_simulated_data_label();
-    if (! data_record_.has(sd_label)) {
+    // Get the 'simulated_data' entry from the event view :
+    if (_view_->get_simulated_data() == 0) {
       DT_LOG_ERROR(get_logging_priority(), "Missing simulated data to be processed !");
       return dpp::base_module::PROCESS_ERROR;
     }
-    // Get the 'simulated_data' entry from the data model :
-    const mctools::simulated_data & sd = data_record_.get<mctools::simulated_data>(sd_label);
+    const mctools::simulated_data & sd = *_view_->get_simulated_data();
 
     DT_LOG_DEBUG(get_logging_priority(), "Simulated data : ");
     if (get_logging_priority() >= datatools::logger::PRIO_DEBUG) sd.tree_dump();
@@ -131,35 +196,40 @@ namespace analysis {
     //   if (i.is_gamma()) _efficiency_.ngamma++;
     // }
 
-    // Check if some 'calibrated_data' are available in the data model:
-    const std::string cd_label = snemo::datamodel::data_info::default_calibrated_data_label();
-    if (! data_record_.has(cd_label)) {
+    // Get the 'calibrated_data' entry from the event view :
+    if (_view_->get_calibrated_data() == 0) {
       DT_LOG_ERROR(get_logging_priority(), "Missing calibrated data to be processed !");
       return dpp::base_module::PROCESS_ERROR;
     }
-    // Get the 'calibrated_data' entry from the data model :
-    const snemo::datamodel::calibrated_data & cd
-      = data_record_.get<snemo::datamodel::calibrated_data>(cd_label);
+    const snemo::datamodel::calibrated_data & cd = *_view_->get_calibrated_data();
 
     DT_LOG_DEBUG(get_logging_priority(), "Calibrated data : ");
     if (get_logging_priority() >= datatools::logger::PRIO_DEBUG) cd.tree_dump();
 
-    // Stop proccess if no calibrated calorimeters
-    if (! cd.has_calibrated_calorimeter_hits()) return dpp::base_module::PROCESS_STOP;
+    // Events without calibrated calorimeters have no simulated gammas but are
+    // still counted by the sequence comparison
+    if (! cd.has_calibrated_calorimeter_hits()) {
+      simulated_gammas_.finalize();
+      return dpp::base_module::PROCESS_OK;
+    }
     const snemo::datamodel::calibrated_data::calorimeter_hit_collection_type & cch
       = cd.calibrated_calorimeter_hits();
+    _calibrated_channels_.clear();
+    for (const auto & a_calo : cch) {
+      _calibrated_channels_.insert(_channels_.get_channel(a_calo.get().get_geom_id()));
+    }
 
     // Fetch simulated step hits from calorimeter blocks
-    const std::string hit_label = "__visu.tracks.calo";
-    if (! sd.has_step_hits(hit_label)) return dpp::base_module::PROCESS_STOP;
-    const mctools::simulated_data::hit_handle_collection_type & hit_collection
-      = sd.get_step_hits(hit_label);
-    if (hit_collection.empty()) {
+    static const std::string hit_label = "__visu.tracks.calo";
+    if (! sd.has_step_hits(hit_label) || sd.get_step_hits(hit_label).empty()) {
       DT_LOG_DEBUG(get_logging_priority(), "No simulated calorimeter hits");
-      return dpp::base_module::PROCESS_STOP;
+      simulated_gammas_.finalize();
+      return dpp::base_module::PROCESS_OK;
     }
+    const mctools::simulated_data::hit_handle_collection_type & hit_collection
+      = sd.get_step_hits(hit_label);
 
-    for (auto ihit : hit_collection) {
+    for (const auto & ihit : hit_collection) {
       const mctools::base_step_hit & a_hit = ihit.get();
       const datatools::properties & a_aux = a_hit.get_auxiliaries();
 
@@ -174,44 +244,40 @@ namespace analysis {
       if (track_id == 0) continue; // Primary particles
 
       // Check if calorimeter has been calibrated
-      const geomtools::geom_id & gid = a_hit.get_geom_id();
-      if (std::find_if(cch.begin(), cch.end(), [gid] (auto hit_) {
-            return gid == hit_.get().get_geom_id();
-          }) == cch.end()) continue;
+      const uint32_t channel = _channels_.get_channel(a_hit.get_geom_id());
+      if (! _calibrated_channels_.contains(channel)) continue;
 
-
-      simulated_gammas_[track_id].insert(gid);
+      simulated_gammas_.add(track_id, channel, a_hit.get_time_start());
     }
+    simulated_gammas_.finalize();
 
     return dpp::base_module::PROCESS_OK;
   }
 
-  dpp::base_module::process_status snemo_gamma_tracking_studies_module::_process_reconstructed_gammas(const datatools::things & data_record_,
-                                                                                                      gamma_dict_type & reconstructed_gammas_)
+  dpp::base_module::process_status snemo_gamma_tracking_studies_module::_process_reconstructed_gammas(gamma_dict_type & reconstructed_gammas_)
   {
-    // Check if some 'particle_track_data' are available in the data model:
-    const std::string ptd_label = snemo::datamodel::data_info::default_particle_track_data_label();
-    if (! data_record_.has(ptd_label)) {
+    // Get the 'particle_track_data' entry from the event view :
+    if (_view_->get_particle_track_data() == 0) {
       DT_LOG_ERROR(get_logging_priority(), "Missing particle track data to be processed !");
       return dpp::base_module::PROCESS_ERROR;
     }
-    // Get the 'particle_track_data' entry from the data model :
-    const snemo::datamodel::particle_track_data & ptd
-      = data_record_.get<snemo::datamodel::particle_track_data>(ptd_label);
+    const snemo::datamodel::particle_track_data & ptd = *_view_->get_particle_track_data();
 
     DT_LOG_DEBUG(get_logging_priority(), "Particle track data : ");
     if (get_logging_priority() >= datatools::logger::PRIO_DEBUG) ptd.tree_dump();
 
-    snemo::datamodel::particle_track_data::particle_collection_type gammas;
-    const size_t ngammas = ptd.fetch_particles(gammas, snemo::datamodel::particle_track::NEUTRAL);
-    if (ngammas == 0) return dpp::base_module::PROCESS_STOP;
+    // Neutral particles are shared with other modules using the view
+    const snemo::analysis::event_view::particle_collection_type & the_gammas
+      = _view_->get_particles(snemo::datamodel::particle_track::NEUTRAL);
 
-    for (auto igamma : gammas) {
-      for (auto icalo : igamma.get().get_associated_calorimeter_hits()) {
-        const geomtools::geom_id & gid = icalo.get().get_geom_id();
-        reconstructed_gammas_[igamma.get().get_track_id()].insert(gid);
+    for (const auto & igamma : the_gammas) {
+      const int track_id = igamma.get().get_track_id();
+      for (const auto & icalo : igamma.get().get_associated_calorimeter_hits()) {
+        reconstructed_gammas_.add(track_id, _channels_.get_channel(icalo.get().get_geom_id()),
+                                  icalo.get().get_time());
       }
     }
+    reconstructed_gammas_.finalize();
 
     return dpp::base_module::PROCESS_OK;
   }
@@ -220,6 +286,9 @@ namespace analysis {
                                                                const gamma_dict_type & reconstructed_gammas_)
   {
     _efficiency_.nevent++;
+    const size_t nsim = std::min(simulated_gammas_.size(), gamma_tracking_efficiency::MAX_MULTIPLICITY);
+    const size_t nrec = std::min(reconstructed_gammas_.size(), gamma_tracking_efficiency::MAX_MULTIPLICITY);
+    _efficiency_.confusion[nsim][nrec]++;
     if (reconstructed_gammas_.empty() && simulated_gammas_.empty()) {
       DT_LOG_DEBUG(get_logging_priority(), "No gammas have been catched and reconstructed !");
       _efficiency_.nmiss++;
@@ -229,38 +298,77 @@ namespace analysis {
 
     if (get_logging_priority() >= datatools::logger::PRIO_DEBUG) {
       DT_LOG_DEBUG(get_logging_priority(), "Simulated gammas :");
-      for (auto i : simulated_gammas_) {
+      for (size_t i = 0; i < simulated_gammas_.size(); i++) {
+        const calo_sequence a_sequence = simulated_gammas_.get_sequence(i);
         std::ostringstream oss;
-        oss << "Gamma #" << i.first << " :";
-        for (auto icalo : i.second) {
-          oss << " -> " << icalo;
+        oss << "Gamma #" << simulated_gammas_.get_track_id(i) << " :";
+        for (size_t j = 0; j < a_sequence.size(); j++) {
+          oss << " -> " << _channels_.get_geom_id(a_sequence.ordered[j]);
         }
         DT_LOG_DEBUG(get_logging_priority(), oss.str());
       }
       DT_LOG_DEBUG(get_logging_priority(), "Reconstructed gammas :");
-      for (auto i : reconstructed_gammas_) {
+      for (size_t i = 0; i < reconstructed_gammas_.size(); i++) {
+        const calo_sequence a_sequence = reconstructed_gammas_.get_sequence(i);
         std::ostringstream oss;
-        oss << "Gamma #" << i.first << " :";
-        for (auto icalo : i.second) {
-          oss << " -> " << icalo;
+        oss << "Gamma #" << reconstructed_gammas_.get_track_id(i) << " :";
+        for (size_t j = 0; j < a_sequence.size(); j++) {
+          oss << " -> " << _channels_.get_geom_id(a_sequence.ordered[j]);
         }
         DT_LOG_DEBUG(get_logging_priority(), oss.str());
       }
     }
 
-    for (auto irec : reconstructed_gammas_) {
-      const calo_list_type & a_rec_list = irec.second;
-      for (auto isim : simulated_gammas_) {
-        const calo_list_type & a_sim_list = isim.second;
-        if (a_rec_list.size() != a_sim_list.size()) continue;
-        const bool are_same = std::equal(a_rec_list.begin(), a_rec_list.end(), a_sim_list.begin());
-        if (are_same) {
-          _efficiency_.ngood++;
-          DT_LOG_DEBUG(get_logging_priority(), "Sequences are identical !");
-          break;
-        }
+    for (size_t i = 0; i < reconstructed_gammas_.size(); i++) {
+      if (simulated_gammas_.find_same(reconstructed_gammas_.get_sequence(i)) >= 0) {
+        _efficiency_.ngood++;
+        DT_LOG_DEBUG(get_logging_priority(), "Sequences are identical !");
+      }
+    }
+
+    // Mark the reconstructed gamma holding each channel
+    for (size_t i = 0; i < reconstructed_gammas_.size(); i++) {
+      const calo_sequence a_rec_sequence = reconstructed_gammas_.get_sequence(i);
+      for (size_t j = 0; j < a_rec_sequence.size(); j++) {
+        const uint32_t a_channel = a_rec_sequence.channels[j];
+        if (a_channel >= _channel_owners_.size()) _channel_owners_.resize(a_channel + 1, -1);
+        _channel_owners_[a_channel] = i;
+      }
+    }
+
+    // Partial matching of each simulated gamma with its best reconstructed gamma
+    _overlaps_.assign(reconstructed_gammas_.size(), 0);
+    for (size_t i = 0; i < simulated_gammas_.size(); i++) {
+      const calo_sequence a_sim_sequence = simulated_gammas_.get_sequence(i);
+      std::fill(_overlaps_.begin(), _overlaps_.end(), 0);
+      size_t best = 0;
+      for (size_t j = 0; j < a_sim_sequence.size(); j++) {
+        const uint32_t a_channel = a_sim_sequence.channels[j];
+        if (a_channel >= _channel_owners_.size() || _channel_owners_[a_channel] < 0) continue;
+        const size_t owner = _channel_owners_[a_channel];
+        if (++_overlaps_[owner] > _overlaps_[best]) best = owner;
+      }
+      if (_overlaps_.empty() || _overlaps_[best] == 0) continue;
+      const calo_sequence a_rec_sequence = reconstructed_gammas_.get_sequence(best);
+      const size_t ncommon = _overlaps_[best];
+      _efficiency_.nmatched++;
+      _efficiency_.sum_jaccard += ncommon / (double)(a_sim_sequence.size() + a_rec_sequence.size() - ncommon);
+      if (a_sim_sequence.front() == a_rec_sequence.front()) {
+        _efficiency_.nfirst++;
+      }
+      if (ncommon == a_sim_sequence.size() && a_sim_sequence.is_same_order(a_rec_sequence)) {
+        _efficiency_.nordered++;
       }
     }
+
+    // Release channel marks
+    for (size_t i = 0; i < reconstructed_gammas_.size(); i++) {
+      const calo_sequence a_rec_sequence = reconstructed_gammas_.get_sequence(i);
+      for (size_t j = 0; j < a_rec_sequence.size(); j++) {
+        _channel_owners_[a_rec_sequence.channels[j]] = -1;
+      }
+    }
+    return;
   }
 
 } // namespace analysis
@@ -34,26 +34,28 @@
 #define ANALYSIS_SNEMO_GAMMA_TRACKING_STUDIES_MODULE_H_ 1
 
 // Standard libraires:
-#include <set>
-#include <map>
-// Third party:
-// - Bayeux/geomtools:
-#include <geomtools/geom_id.h>
+#include <string>
+#include <vector>
 
 // Data processing module abstract base class
 #include <dpp/base_module.h>
 
+// - Shared event view
+#include <event_view.h>
+
+// This project:
+#include <gamma_dict.h>
+#include <calo_channel_index.h>
+#include <gamma_tracking_efficiency.h>
+
 namespace analysis {
 
   class snemo_gamma_tracking_studies_module : public dpp::base_module
   {
   public:
 
-    /// Typedef for calorimeters collection
-    typedef std::set<geomtools::geom_id> calo_list_type;
-
     /// Typedef for gamma dictionnaries
-    typedef std::map<int, calo_list_type> gamma_dict_type;
+    typedef gamma_dict gamma_dict_type;
 
     /// Constructor
     snemo_gamma_tracking_studies_module(datatools::logger::priority = datatools::logger::PRIO_FATAL);
@@ -78,12 +80,10 @@ namespace analysis {
     void _set_defaults();
 
     /// Get gammas sequence from 'simulated_data' bank
-    dpp::base_module::process_status _process_simulated_gammas(const datatools::things & data_,
-                                                               gamma_dict_type & gammas_);
+    dpp::base_module::process_status _process_simulated_gammas(gamma_dict_type & gammas_);
 
     /// Get gammas sequence from 'particle_track_data' bank
-    dpp::base_module::process_status _process_reconstructed_gammas(const datatools::things & data_,
-                                                                   gamma_dict_type & gammas_);
+    dpp::base_module::process_status _process_reconstructed_gammas(gamma_dict_type & gammas_);
 
     /// Compare 2 sequences of calorimeters
     void _compare_sequences(const gamma_dict_type & simulated_gammas_,
@@ -91,16 +91,44 @@ namespace analysis {
 
   private:
 
-    /// Internal structure to compute efficiency
-    struct efficiency_type {
-      size_t nevent; //!< Total number of event processed
-      size_t ntotal; //!< Total number of gammas simulated
-      size_t ngood;  //!< Number of gammas well reconstructed
-      size_t nmiss;  //!< Number of gammas that do not trigger detector
-    };
-
     /// Efficiency structure
-    efficiency_type _efficiency_;
+    gamma_tracking_efficiency _efficiency_;
+
+    /// File where to store the efficiency record
+    std::string _efficiency_filename_;
+
+    /// Dense numbering of calorimeter channels
+    calo_channel_index _channels_;
+
+    /// Calibrated calorimeter channels of the current event
+    calo_channel_set _calibrated_channels_;
+
+    /// Index of the reconstructed gamma holding each channel (-1 if none)
+    std::vector<int> _channel_owners_;
+
+    /// Number of channels shared with each reconstructed gamma
+    std::vector<size_t> _overlaps_;
+
+    /// Simulated gammas of the current event
+    gamma_dict_type _simulated_gammas_;
+
+    /// Reconstructed gammas of the current event
+    gamma_dict_type _reconstructed_gammas_;
+
+    /// Event view of the current record (shared or owned by the module)
+    snemo::analysis::event_view * _view_;
+
+    /// Event view owned by the module
+    snemo::analysis::event_view _local_view_;
+
+    /// Event view of the 'EventView' service (optional)
+    snemo::analysis::event_view * _shared_view_;
+
+    /// Serial of the shared view at the previous call
+    uint64_t _shared_view_serial_;
+
+    /// Flag set once the shared view has been checked
+    bool _shared_view_checked_;
 
     // Macro to automate the registration of the module :
     DPP_MODULE_REGISTRATION_INTERFACE(snemo_gamma_tracking_studies_module);
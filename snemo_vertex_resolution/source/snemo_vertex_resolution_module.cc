@@ -6,12 +6,15 @@
 // Standard library:
 #include <stdexcept>
 #include <sstream>
+#include <iomanip>
 #include <numeric>
+#include <algorithm>
 
 // Third party:
 // - Bayeux/datatools:
 #include <datatools/clhep_units.h>
 #include <datatools/service_manager.h>
+#include <datatools/utils.h>
 // - Bayeux/mygsl
 #include <mygsl/histogram_pool.h>
 // - Bayeux/dpp
@@ -29,6 +32,39 @@ namespace analysis {
   DPP_MODULE_REGISTRATION_IMPLEMENT(snemo_vertex_resolution_module,
                                     "analysis::snemo_vertex_resolution_module");
 
+  snemo_vertex_resolution_module::vertex_category_type
+  snemo_vertex_resolution_module::get_vertex_category(const std::string & label_)
+  {
+    if (label_ == snemo::datamodel::particle_track::vertex_on_source_foil_label()) {
+      return VERTEX_CATEGORY_FOIL;
+    } else if (label_ == snemo::datamodel::particle_track::vertex_on_main_calorimeter_label()) {
+      return VERTEX_CATEGORY_CALO;
+    } else if (label_ == snemo::datamodel::particle_track::vertex_on_x_calorimeter_label()) {
+      return VERTEX_CATEGORY_XCALO;
+    } else if (label_ == snemo::datamodel::particle_track::vertex_on_gamma_veto_label()) {
+      return VERTEX_CATEGORY_GVETO;
+    }
+    return VERTEX_CATEGORY_INVALID;
+  }
+
+  const std::string &
+  snemo_vertex_resolution_module::get_vertex_category_label(const vertex_category_type category_)
+  {
+    switch (category_) {
+    case VERTEX_CATEGORY_CALO:
+      return snemo::datamodel::particle_track::vertex_on_main_calorimeter_label();
+    case VERTEX_CATEGORY_XCALO:
+      return snemo::datamodel::particle_track::vertex_on_x_calorimeter_label();
+    case VERTEX_CATEGORY_GVETO:
+      return snemo::datamodel::particle_track::vertex_on_gamma_veto_label();
+    default:
+      break;
+    }
+    DT_THROW_IF(category_ != VERTEX_CATEGORY_FOIL, std::logic_error,
+                "Invalid vertex category '" << category_ << "' !");
+    return snemo::datamodel::particle_track::vertex_on_source_foil_label();
+  }
+
   // Set the histogram pool used by the module :
   void snemo_vertex_resolution_module::set_histogram_pool(mygsl::histogram_pool & pool_)
   {
@@ -49,6 +85,14 @@ namespace analysis {
   void snemo_vertex_resolution_module::_set_defaults()
   {
     _histogram_pool_ = 0;
+    _residual_histograms_.clear();
+    _energy_bins_.clear();
+    _binned_histograms_.clear();
+    _store_residuals_ = false;
+    _residual_filename_.clear();
+    _residuals_.clear();
+    _fit_residuals_ = false;
+    _fitter_ = vertex_resolution_fitter();
     return;
   }
 
@@ -110,6 +154,64 @@ namespace analysis {
       }
     }
 
+    // Energy binning of residual histograms
+    if (config_.has_key("energy_bins")) {
+      config_.fetch("energy_bins", _energy_bins_);
+      DT_THROW_IF(_energy_bins_.size() < 2, std::logic_error,
+                  "Module '" << get_name() << "' needs at least two energy bin edges !");
+      for (size_t i = 0; i < _energy_bins_.size(); i++) {
+        _energy_bins_[i] /= CLHEP::keV;
+      }
+      DT_THROW_IF(! std::is_sorted(_energy_bins_.begin(), _energy_bins_.end()), std::logic_error,
+                  "Module '" << get_name() << "' energy bin edges must be sorted !");
+
+      // Build all the histograms once for all
+      const size_t nbins = _energy_bins_.size() - 1;
+      _binned_histograms_.resize(nbins * NUMBER_OF_VERTEX_CATEGORIES);
+      for (size_t ibin = 0; ibin < nbins; ibin++) {
+        std::ostringstream energy_label;
+        energy_label << std::setw(4) << _energy_bins_[ibin] << "-"
+                     << std::setw(4) << _energy_bins_[ibin+1] << "keV_";
+        for (int icat = 0; icat < NUMBER_OF_VERTEX_CATEGORIES; icat++) {
+          _build_residual_histograms_(energy_label.str(), static_cast<vertex_category_type>(icat),
+                                      _binned_histograms_[ibin * NUMBER_OF_VERTEX_CATEGORIES + icat]);
+        }
+      }
+      // Use the same binning for resolution fit
+      _fitter_.set_energy_bins(_energy_bins_);
+    }
+
+    // Unbinned residuals
+    if (config_.has_key("residuals.store")) {
+      _store_residuals_ = config_.fetch_boolean("residuals.store");
+    }
+    if (_store_residuals_) {
+      if (config_.has_key("residuals.output_file")) {
+        _residual_filename_ = config_.fetch_string("residuals.output_file");
+        datatools::fetch_path_with_env(_residual_filename_);
+      }
+      if (config_.has_key("residuals.fit")) {
+        _fit_residuals_ = config_.fetch_boolean("residuals.fit");
+      }
+      if (config_.has_key("residuals.fit.energy_bins")) {
+        std::vector<double> energy_bins;
+        config_.fetch("residuals.fit.energy_bins", energy_bins);
+        for (size_t i = 0; i < energy_bins.size(); i++) {
+          energy_bins[i] /= CLHEP::keV;
+        }
+        _fitter_.set_energy_bins(energy_bins);
+      }
+      if (config_.has_key("residuals.fit.number_of_threads")) {
+        _fitter_.set_number_of_threads(config_.fetch_integer("residuals.fit.number_of_threads"));
+      }
+      if (config_.has_key("residuals.fit.core_window")) {
+        _fitter_.set_core_window(config_.fetch_real("residuals.fit.core_window"));
+      }
+      DT_THROW_IF(_residual_filename_.empty() && ! _fit_residuals_, std::logic_error,
+                  "Module '" << get_name() << "' keeps unbinned residuals but neither stores "
+                  << "them ('residuals.output_file') nor fits them ('residuals.fit') !");
+    }
+
     // Tag the module as initialized :
     _set_initialized (true);
     return;
@@ -128,6 +230,20 @@ namespace analysis {
       dump_result();
     }
 
+    // Save and analyse unbinned residuals
+    if (! _residual_filename_.empty()) {
+      DT_LOG_NOTICE(get_logging_priority(), "Storing " << _residuals_.size()
+                    << " vertex residuals into '" << _residual_filename_ << "'");
+      _residuals_.store(_residual_filename_);
+    }
+    if (_fit_residuals_) {
+      vertex_resolution_fitter::result_collection_type results;
+      _fitter_.fit(_residuals_, results);
+      std::ostringstream oss;
+      vertex_resolution_fitter::print(results, oss);
+      DT_LOG_NOTICE(get_logging_priority(), "Vertex resolutions :" << std::endl << oss.str());
+    }
+
     _set_defaults();
 
     // Tag the module as un-initialized :
@@ -169,6 +285,13 @@ namespace analysis {
       ptd.tree_dump();
     }
 
+    // Primary kinetic energy used to sort the residual histograms
+    const double energy = sd.get_primary_event().get_total_kinetic_energy()/CLHEP::keV;
+    const int energy_bin = _get_energy_bin_(energy);
+    if (! _energy_bins_.empty() && energy_bin < 0) {
+      DT_LOG_DEBUG(get_logging_priority(), "Primary energy " << energy << " keV is out of energy bins !");
+    }
+
     // Loop over all saved particles
     const snemo::datamodel::particle_track_data::particle_collection_type & the_particles
       = ptd.get_particles();
@@ -192,10 +315,15 @@ namespace analysis {
           DT_LOG_WARNING(get_logging_priority(), "Current vertex has no vertex type !");
           continue;
         }
-        std::string vname = aux.fetch_string(snemo::datamodel::particle_track::vertex_type_key());
+        const std::string & vname = aux.fetch_string(snemo::datamodel::particle_track::vertex_type_key());
+        const vertex_category_type vcategory = get_vertex_category(vname);
+        if (vcategory == VERTEX_CATEGORY_INVALID) {
+          DT_LOG_WARNING(get_logging_priority(), "Vertex category '" << vname << "' is not supported ! Skip !");
+          continue;
+        }
 
         // Calculate delta vertex
-        if (snemo::datamodel::particle_track::vertex_is_on_source_foil(a_vertex)) {
+        if (vcategory == VERTEX_CATEGORY_FOIL) {
           delta = a_vertex.get_position() - sd.get_vertex();
         } else {
           // Getting the simulated hit inside the calorimeter
@@ -214,7 +342,7 @@ namespace analysis {
           const geomtools::geom_id & the_step_hit_gid = the_step_hit.get_geom_id();
 
           // Get the associated calorimeter list
-          const snemo::datamodel::calibrated_calorimeter_hit::collection_type calos
+          const snemo::datamodel::calibrated_calorimeter_hit::collection_type & calos
             = a_particle.get_associated_calorimeter_hits();
           if (calos.size() != 1) {
             DT_LOG_WARNING(get_logging_priority(), "More than one calorimeter associated to the particle track ! Skip !");
@@ -237,27 +365,22 @@ namespace analysis {
         DT_THROW_IF(!geomtools::is_valid(delta), std::logic_error,
                     "Something gets wrong when vertex difference has been calculated");
 
-        // Getting histogram pool
-        mygsl::histogram_pool & a_pool = grab_histogram_pool();
-        const std::string label[3] = { "x", "y", "z"};
-        for (size_t i = 0; i < 3; i++) {
-          std::ostringstream key;
-          key << std::setw(4) << sd.get_primary_event().get_total_kinetic_energy()/CLHEP::keV << "keV_";
-          std::ostringstream group;
-          group << vname << "_" << label[i] << "_position";
-          key << group.str();
-          if (! a_pool.has(key.str())) {
-            mygsl::histogram_1d & h = a_pool.add_1d(key.str(), "", group.str());
-            datatools::properties hconfig;
-            hconfig.store_string("mode", "mimic");
-            hconfig.store_string("mimic.histogram_1d", "delta_" + label[i]);
-            mygsl::histogram_pool::init_histo_1d(h, hconfig, &a_pool);
+        if (_store_residuals_) {
+          _residuals_.add(energy, vcategory,
+                          delta.x()/CLHEP::mm, delta.y()/CLHEP::mm, delta.z()/CLHEP::mm);
+        }
+
+        // Getting the residual histograms
+        const residual_histograms_type * the_histos = 0;
+        if (_energy_bins_.empty()) {
+          the_histos = &_grab_residual_histograms_(energy, vcategory);
+        } else if (energy_bin >= 0) {
+          the_histos = &_binned_histograms_[energy_bin * NUMBER_OF_VERTEX_CATEGORIES + vcategory];
+        }
+        if (the_histos != 0) {
+          for (size_t i = 0; i < 3; i++) {
+            the_histos->delta[i]->fill(delta[i]);
           }
-          // Getting the current histogram
-          mygsl::histogram_1d & a_histo = a_pool.grab_1d(key.str ());
-          if (label[i] == "x") a_histo.fill(delta.x());
-          if (label[i] == "y") a_histo.fill(delta.y());
-          if (label[i] == "z") a_histo.fill(delta.z());
         }
       }// end of vertex list
     }// end of particle list
@@ -266,6 +389,55 @@ namespace analysis {
     return dpp::base_module::PROCESS_SUCCESS;
   }
 
+  const snemo_vertex_resolution_module::residual_histograms_type &
+  snemo_vertex_resolution_module::_grab_residual_histograms_(const double energy_,
+                                                             const vertex_category_type category_)
+  {
+    const residual_key_type a_key = std::make_pair(energy_, (int)category_);
+    residual_dict_type::const_iterator found = _residual_histograms_.find(a_key);
+    if (found != _residual_histograms_.end()) {
+      return found->second;
+    }
+
+    // First time this (energy, category) pair shows up: create the histograms
+    // from templates and keep their addresses for the next fills
+    std::ostringstream energy_label;
+    energy_label << std::setw(4) << energy_ << "keV_";
+    residual_histograms_type & the_histos = _residual_histograms_[a_key];
+    _build_residual_histograms_(energy_label.str(), category_, the_histos);
+    return the_histos;
+  }
+
+  void snemo_vertex_resolution_module::_build_residual_histograms_(const std::string & energy_label_,
+                                                                   const vertex_category_type category_,
+                                                                   residual_histograms_type & histos_)
+  {
+    mygsl::histogram_pool & a_pool = *_histogram_pool_;
+    const std::string label[3] = { "x", "y", "z"};
+    for (size_t i = 0; i < 3; i++) {
+      std::ostringstream group;
+      group << get_vertex_category_label(category_) << "_" << label[i] << "_position";
+      const std::string key = energy_label_ + group.str();
+      if (! a_pool.has(key)) {
+        mygsl::histogram_1d & h = a_pool.add_1d(key, "", group.str());
+        datatools::properties hconfig;
+        hconfig.store_string("mode", "mimic");
+        hconfig.store_string("mimic.histogram_1d", "delta_" + label[i]);
+        mygsl::histogram_pool::init_histo_1d(h, hconfig, &a_pool);
+      }
+      histos_.delta[i] = &a_pool.grab_1d(key);
+    }
+    return;
+  }
+
+  int snemo_vertex_resolution_module::_get_energy_bin_(const double energy_) const
+  {
+    if (_energy_bins_.empty()) return -1;
+    if (energy_ < _energy_bins_.front() || energy_ >= _energy_bins_.back()) return -1;
+    return std::upper_bound(_energy_bins_.begin(), _energy_bins_.end(), energy_)
+      - _energy_bins_.begin() - 1;
+  }
+
   void snemo_vertex_resolution_module::dump_result(std::ostream      & out_,
                                                    const std::string & title_,
                                                    const std::string & indent_,
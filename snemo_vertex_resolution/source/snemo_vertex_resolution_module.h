@@ -32,11 +32,22 @@
 #ifndef ANALYSIS_SNEMO_VERTEX_RESOLUTION_MODULE_H
 #define ANALYSIS_SNEMO_VERTEX_RESOLUTION_MODULE_H 1
 
+// Standard library:
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
 // Data processing module abstract base class
 #include <dpp/base_module.h>
 
+// This project:
+#include <vertex_residual_store.h>
+#include <vertex_resolution_fitter.h>
+
 namespace mygsl {
   class histogram_pool;
+  class histogram_1d;
 }
 
 namespace analysis {
@@ -45,6 +56,22 @@ namespace analysis {
   {
   public:
 
+    /// Vertex categories studied by the module
+    enum vertex_category_type {
+      VERTEX_CATEGORY_INVALID = -1,
+      VERTEX_CATEGORY_FOIL    = 0,
+      VERTEX_CATEGORY_CALO    = 1,
+      VERTEX_CATEGORY_XCALO   = 2,
+      VERTEX_CATEGORY_GVETO   = 3,
+      NUMBER_OF_VERTEX_CATEGORIES
+    };
+
+    /// Return the vertex category given the vertex type label
+    static vertex_category_type get_vertex_category(const std::string & label_);
+
+    /// Return the vertex type label of a given vertex category
+    static const std::string & get_vertex_category_label(const vertex_category_type category_);
+
     /// Setting histogram pool
     void set_histogram_pool(mygsl::histogram_pool & pool_);
 
@@ -79,11 +106,60 @@ namespace analysis {
     /// Give default values to specific class members.
     void _set_defaults();
 
+  private:
+
+    /// Histogram handles for the x, y, z residuals
+    struct residual_histograms_type {
+      mygsl::histogram_1d * delta[3];
+    };
+
+    /// Typedef for residual histogram key i.e. (energy in keV, vertex category)
+    typedef std::pair<double, int> residual_key_type;
+
+    /// Typedef for residual histogram dictionary
+    typedef std::map<residual_key_type, residual_histograms_type> residual_dict_type;
+
+    /// Return the residual histograms, building them at first call
+    const residual_histograms_type & _grab_residual_histograms_(const double energy_,
+                                                                const vertex_category_type category_);
+
+    /// Build (or fetch) the residual histograms given an energy label
+    void _build_residual_histograms_(const std::string & energy_label_,
+                                     const vertex_category_type category_,
+                                     residual_histograms_type & histos_);
+
+    /// Return the index of the energy bin (-1 if out of range)
+    int _get_energy_bin_(const double energy_) const;
+
   private:
 
     // The histogram pool :
     mygsl::histogram_pool * _histogram_pool_;
 
+    // Residual histograms resolved so far (exact energy mode) :
+    residual_dict_type _residual_histograms_;
+
+    // Energy bin edges in keV (empty for exact energy mode) :
+    std::vector<double> _energy_bins_;
+
+    // Residual histograms indexed by energy bin and vertex category :
+    std::vector<residual_histograms_type> _binned_histograms_;
+
+    // Flag to keep unbinned residuals :
+    bool _store_residuals_;
+
+    // Output file of the unbinned residuals :
+    std::string _residual_filename_;
+
+    // Unbinned residuals :
+    vertex_residual_store _residuals_;
+
+    // Flag to estimate resolutions from unbinned residuals :
+    bool _fit_residuals_;
+
+    // Resolution fitter :
+    vertex_resolution_fitter _fitter_;
+
     // Macro to automate the registration of the module :
     DPP_MODULE_REGISTRATION_INTERFACE(snemo_vertex_resolution_module);
   };
@@ -0,0 +1,97 @@
+/// vertex_residual_store.cc
+
+// Ourselves:
+#include <vertex_residual_store.h>
+
+// Standard library:
+#include <stdexcept>
+#include <fstream>
+#include <stdint.h>
+
+// Third party:
+// - Bayeux/datatools:
+#include <datatools/exception.h>
+
+namespace analysis {
+
+  namespace {
+    /// File signature
+    const char MAGIC[8] = { 'S', 'N', 'V', 'R', 'E', 'S', '0', '1' };
+  }
+
+  vertex_residual_store::vertex_residual_store()
+  {
+    return;
+  }
+
+  void vertex_residual_store::reserve(const size_t nentries_)
+  {
+    for (size_t i = 0; i < NUMBER_OF_COLUMNS; i++) {
+      _columns_[i].reserve(nentries_);
+    }
+    return;
+  }
+
+  void vertex_residual_store::add(const float energy_, const int category_,
+                                  const float dx_, const float dy_, const float dz_)
+  {
+    _columns_[COLUMN_ENERGY].push_back(energy_);
+    _columns_[COLUMN_CATEGORY].push_back(category_);
+    _columns_[COLUMN_DELTA_X].push_back(dx_);
+    _columns_[COLUMN_DELTA_Y].push_back(dy_);
+    _columns_[COLUMN_DELTA_Z].push_back(dz_);
+    return;
+  }
+
+  size_t vertex_residual_store::size() const
+  {
+    return _columns_[COLUMN_ENERGY].size();
+  }
+
+  bool vertex_residual_store::empty() const
+  {
+    return size() == 0;
+  }
+
+  const float * vertex_residual_store::get_column(const column_type column_) const
+  {
+    DT_THROW_IF(column_ >= NUMBER_OF_COLUMNS, std::range_error,
+                "Invalid column index '" << column_ << "' !");
+    if (empty()) return 0;
+    return &_columns_[column_][0];
+  }
+
+  void vertex_residual_store::clear()
+  {
+    for (size_t i = 0; i < NUMBER_OF_COLUMNS; i++) {
+      std::vector<float>().swap(_columns_[i]);
+    }
+    return;
+  }
+
+  void vertex_residual_store::store(const std::string & filename_) const
+  {
+    std::ofstream fout(filename_.c_str(), std::ios::binary | std::ios::trunc);
+    DT_THROW_IF(! fout, std::runtime_error, "Cannot open file '" << filename_ << "' !");
+    const uint64_t nentries = size();
+    fout.write(MAGIC, sizeof(MAGIC));
+    fout.write(reinterpret_cast<const char *>(&nentries), sizeof(nentries));
+    for (size_t i = 0; i < NUMBER_OF_COLUMNS; i++) {
+      const float * a_column = get_column(static_cast<column_type>(i));
+      if (a_column == 0) continue;
+      fout.write(reinterpret_cast<const char *>(a_column), nentries * sizeof(float));
+    }
+    DT_THROW_IF(! fout, std::runtime_error, "Writing into file '" << filename_ << "' fails !");
+    return;
+  }
+
+} // namespace analysis
+
+// end of vertex_residual_store.cc
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
@@ -0,0 +1,119 @@
+/// \file vertex_residual_store.h
+/* Author(s)     : Xavier Garrido <garrido@lal.in2p3.fr>
+ * Creation date : 2026-10-18
+ * Last modified : 2026-10-18
+ *
+ * Copyright (C) 2026 Xavier Garrido <garrido@lal.in2p3.fr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * Description:
+ *
+ *   Unbinned columnar store of vertex residuals. Each entry holds the
+ *   primary kinetic energy (keV), the vertex category and the x, y, z
+ *   residuals (mm), all saved as 32 bits floats.
+ *
+ *   The binary file layout is a fixed size header followed by the 5 columns
+ *   written one after the other, so that each column of a stored file can be
+ *   read back as a plain float array:
+ *
+ *     char[8]  magic "SNVRES01"
+ *     uint64   number of entries N
+ *     float[N] energy
+ *     float[N] category
+ *     float[N] delta x
+ *     float[N] delta y
+ *     float[N] delta z
+ *
+ * History:
+ *
+ */
+
+#ifndef ANALYSIS_VERTEX_RESIDUAL_STORE_H
+#define ANALYSIS_VERTEX_RESIDUAL_STORE_H 1
+
+// Standard library:
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace analysis {
+
+  /// \brief Columnar store of vertex residuals
+  class vertex_residual_store
+  {
+  public:
+
+    /// Column identifiers
+    enum column_type {
+      COLUMN_ENERGY   = 0,
+      COLUMN_CATEGORY = 1,
+      COLUMN_DELTA_X  = 2,
+      COLUMN_DELTA_Y  = 3,
+      COLUMN_DELTA_Z  = 4,
+      NUMBER_OF_COLUMNS
+    };
+
+    /// Default constructor
+    vertex_residual_store();
+
+    /// Reserve memory for a given number of entries
+    void reserve(const size_t nentries_);
+
+    /// Append a new entry (energy in keV, residuals in mm)
+    void add(const float energy_, const int category_,
+             const float dx_, const float dy_, const float dz_);
+
+    /// Return the number of entries
+    size_t size() const;
+
+    /// Check if the store is empty
+    bool empty() const;
+
+    /// Return a column as a contiguous float array of size()
+    const float * get_column(const column_type column_) const;
+
+    /// Remove all entries and release memory
+    void clear();
+
+    /// Write the content into a binary file
+    void store(const std::string & filename_) const;
+
+  private:
+
+    /// Non copyable constructor
+    vertex_residual_store(const vertex_residual_store &);
+
+    /// Non-copyable assignation
+    vertex_residual_store & operator=(const vertex_residual_store &);
+
+  private:
+
+    std::vector<float> _columns_[NUMBER_OF_COLUMNS]; //!< Columns
+
+  };
+
+} // namespace analysis
+
+#endif // ANALYSIS_VERTEX_RESIDUAL_STORE_H
+
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
@@ -0,0 +1,205 @@
+/// vertex_resolution_fitter.cc
+
+// Ourselves:
+#include <vertex_resolution_fitter.h>
+
+// Standard library:
+#include <stdexcept>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <thread>
+#include <utility>
+
+// Third party:
+// - Bayeux/datatools:
+#include <datatools/exception.h>
+
+// This project:
+#include <vertex_residual_store.h>
+
+namespace analysis {
+
+  namespace {
+
+    /// Maximal number of clipping iterations
+    const size_t MAX_ITERATIONS = 50;
+
+    /// Estimate the gaussian core of the values selected by indices
+    void estimate_core(const float * values_,
+                       const std::vector<size_t> & indices_,
+                       const double nsigma_,
+                       vertex_resolution_result & result_)
+    {
+      result_.nentries      = indices_.size();
+      result_.mean          = 0.0;
+      result_.sigma         = 0.0;
+      result_.tail_fraction = 0.0;
+      if (indices_.size() < 2) return;
+
+      double mean  = 0.0;
+      double sigma = std::numeric_limits<double>::infinity();
+      size_t ncore = 0;
+      for (size_t iter = 0; iter < MAX_ITERATIONS; iter++) {
+        double sum = 0.0, sum2 = 0.0;
+        size_t n = 0;
+        const double window = nsigma_ * sigma;
+        for (size_t i = 0; i < indices_.size(); i++) {
+          const double x = values_[indices_[i]];
+          if (std::abs(x - mean) > window) continue;
+          sum  += x;
+          sum2 += x * x;
+          n++;
+        }
+        if (n < 2) break;
+        const double new_mean  = sum / n;
+        const double new_sigma = std::sqrt(std::max(0.0, sum2 / n - new_mean * new_mean));
+        const bool converged = (n == ncore && std::abs(new_sigma - sigma) <= 1e-6 * new_sigma);
+        mean  = new_mean;
+        sigma = new_sigma;
+        ncore = n;
+        if (converged || sigma == 0.0) break;
+      }
+
+      // Correct the RMS for the truncation of the gaussian at +/- nsigma
+      const double k = nsigma_;
+      const double truncated = 1.0 - 2.0 * k * std::exp(-0.5 * k * k) / std::sqrt(2.0 * M_PI)
+        / std::erf(k / std::sqrt(2.0));
+      result_.mean          = mean;
+      result_.sigma         = (truncated > 0.0 ? sigma / std::sqrt(truncated) : sigma);
+      result_.tail_fraction = 1.0 - ncore / (double)indices_.size();
+      return;
+    }
+
+  }
+
+  vertex_resolution_fitter::vertex_resolution_fitter()
+  {
+    _nthreads_    = 0;
+    _core_window_ = 2.5;
+    return;
+  }
+
+  void vertex_resolution_fitter::set_energy_bins(const std::vector<double> & edges_)
+  {
+    DT_THROW_IF(edges_.size() == 1, std::logic_error, "At least two energy bin edges are needed !");
+    DT_THROW_IF(! std::is_sorted(edges_.begin(), edges_.end()), std::logic_error,
+                "Energy bin edges must be sorted !");
+    _energy_bins_ = edges_;
+    return;
+  }
+
+  const std::vector<double> & vertex_resolution_fitter::get_energy_bins() const
+  {
+    return _energy_bins_;
+  }
+
+  void vertex_resolution_fitter::set_number_of_threads(const unsigned int nthreads_)
+  {
+    _nthreads_ = nthreads_;
+    return;
+  }
+
+  void vertex_resolution_fitter::set_core_window(const double nsigma_)
+  {
+    DT_THROW_IF(nsigma_ <= 0.0, std::logic_error, "Core window must be positive !");
+    _core_window_ = nsigma_;
+    return;
+  }
+
+  void vertex_resolution_fitter::fit(const vertex_residual_store & store_,
+                                     result_collection_type & results_) const
+  {
+    results_.clear();
+    if (store_.empty()) return;
+
+    const float * energies   = store_.get_column(vertex_residual_store::COLUMN_ENERGY);
+    const float * categories = store_.get_column(vertex_residual_store::COLUMN_CATEGORY);
+
+    // Energy binning: one bin covering all energies when no edges are given
+    std::vector<double> edges = _energy_bins_;
+    if (edges.empty()) {
+      const std::pair<const float *, const float *> range
+        = std::minmax_element(energies, energies + store_.size());
+      edges.push_back(*range.first);
+      edges.push_back(std::nextafter((double)*range.second, HUGE_VAL));
+    }
+
+    // Group entries by (category, energy bin)
+    typedef std::pair<int, size_t> group_key_type;
+    typedef std::map<group_key_type, std::vector<size_t> > group_dict_type;
+    group_dict_type groups;
+    for (size_t i = 0; i < store_.size(); i++) {
+      const double energy = energies[i];
+      if (energy < edges.front() || energy >= edges.back()) continue;
+      const size_t ibin = std::upper_bound(edges.begin(), edges.end(), energy) - edges.begin() - 1;
+      groups[std::make_pair((int)categories[i], ibin)].push_back(i);
+    }
+
+    // One task per group and axis
+    std::vector<const std::vector<size_t> *> tasks;
+    for (group_dict_type::const_iterator igroup = groups.begin(); igroup != groups.end(); ++igroup) {
+      for (int axis = 0; axis < 3; axis++) {
+        vertex_resolution_result a_result;
+        a_result.category   = igroup->first.first;
+        a_result.axis       = axis;
+        a_result.energy_min = edges[igroup->first.second];
+        a_result.energy_max = edges[igroup->first.second + 1];
+        results_.push_back(a_result);
+        tasks.push_back(&igroup->second);
+      }
+    }
+
+    std::atomic<size_t> next_task(0);
+    auto worker = [&] () {
+      for (size_t itask = next_task++; itask < tasks.size(); itask = next_task++) {
+        vertex_resolution_result & a_result = results_[itask];
+        const vertex_residual_store::column_type column
+          = static_cast<vertex_residual_store::column_type>(vertex_residual_store::COLUMN_DELTA_X + a_result.axis);
+        estimate_core(store_.get_column(column), *tasks[itask], _core_window_, a_result);
+      }
+    };
+    unsigned int nthreads = (_nthreads_ > 0 ? _nthreads_ : std::thread::hardware_concurrency());
+    nthreads = std::max(1u, std::min<unsigned int>(nthreads, tasks.size()));
+    std::vector<std::thread> threads;
+    for (unsigned int i = 1; i < nthreads; i++) {
+      threads.push_back(std::thread(worker));
+    }
+    worker();
+    for (auto & a_thread : threads) {
+      a_thread.join();
+    }
+    return;
+  }
+
+  void vertex_resolution_fitter::print(const result_collection_type & results_, std::ostream & out_)
+  {
+    const char axis_label[3] = { 'x', 'y', 'z' };
+    out_ << "# category energy_min[keV] energy_max[keV] axis entries mean[mm] sigma[mm] tail_fraction"
+         << std::endl;
+    for (const auto & a_result : results_) {
+      out_ << std::setw(2)  << a_result.category << ' '
+           << std::setw(10) << a_result.energy_min << ' '
+           << std::setw(10) << a_result.energy_max << ' '
+           << axis_label[a_result.axis] << ' '
+           << std::setw(8)  << a_result.nentries << ' '
+           << std::setw(12) << a_result.mean << ' '
+           << std::setw(12) << a_result.sigma << ' '
+           << std::setw(12) << a_result.tail_fraction << std::endl;
+    }
+    return;
+  }
+
+} // namespace analysis
+
+// end of vertex_resolution_fitter.cc
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
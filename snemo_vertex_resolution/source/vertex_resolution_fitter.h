@@ -0,0 +1,107 @@
+/// \file vertex_resolution_fitter.h
+/* Author(s)     : Xavier Garrido <garrido@lal.in2p3.fr>
+ * Creation date : 2026-10-18
+ * Last modified : 2026-10-18
+ *
+ * Copyright (C) 2026 Xavier Garrido <garrido@lal.in2p3.fr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * Description:
+ *
+ *   Vertex resolution fitter working on a residual store. For each vertex
+ *   category, energy bin and axis, the gaussian core of the residual
+ *   distribution is estimated by an iterative clipped mean/RMS (corrected
+ *   for the truncation of the gaussian) and the fraction of residuals lying
+ *   in the tails is reported. Distributions are processed in parallel.
+ *
+ * History:
+ *
+ */
+
+#ifndef ANALYSIS_VERTEX_RESOLUTION_FITTER_H
+#define ANALYSIS_VERTEX_RESOLUTION_FITTER_H 1
+
+// Standard library:
+#include <iostream>
+#include <vector>
+#include <cstddef>
+
+namespace analysis {
+
+  class vertex_residual_store;
+
+  /// \brief Resolution estimate of one residual distribution
+  struct vertex_resolution_result
+  {
+    int    category;      //!< Vertex category
+    int    axis;          //!< Axis index (0: x, 1: y, 2: z)
+    double energy_min;    //!< Lower bound of the energy bin (keV)
+    double energy_max;    //!< Upper bound of the energy bin (keV)
+    size_t nentries;      //!< Number of residuals
+    double mean;          //!< Mean of the gaussian core (mm)
+    double sigma;         //!< Width of the gaussian core (mm)
+    double tail_fraction; //!< Fraction of residuals outside the core window
+  };
+
+  /// \brief Multi-threaded vertex resolution fitter
+  class vertex_resolution_fitter
+  {
+  public:
+
+    /// Typedef for fit results
+    typedef std::vector<vertex_resolution_result> result_collection_type;
+
+    /// Default constructor
+    vertex_resolution_fitter();
+
+    /// Set the energy bin edges (keV), a single bin is used if empty
+    void set_energy_bins(const std::vector<double> & edges_);
+
+    /// Return the energy bin edges (keV)
+    const std::vector<double> & get_energy_bins() const;
+
+    /// Set the number of threads (0 means hardware concurrency)
+    void set_number_of_threads(const unsigned int nthreads_);
+
+    /// Set the half width of the core window in units of sigma
+    void set_core_window(const double nsigma_);
+
+    /// Estimate the resolutions
+    void fit(const vertex_residual_store & store_, result_collection_type & results_) const;
+
+    /// Print results as a table
+    static void print(const result_collection_type & results_, std::ostream & out_ = std::clog);
+
+  private:
+
+    std::vector<double> _energy_bins_;   //!< Energy bin edges
+    unsigned int        _nthreads_;      //!< Number of threads
+    double              _core_window_;   //!< Core window half width in sigma unit
+
+  };
+
+} // namespace analysis
+
+#endif // ANALYSIS_VERTEX_RESOLUTION_FITTER_H
+
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/